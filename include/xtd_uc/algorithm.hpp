@@ -13,6 +13,14 @@ namespace xtd {
     return a < b ? a : b;
   }
 
+  template <class InputIt, class Size, class OutputIt>
+  OutputIt copy_n(InputIt first, Size count, OutputIt result) {
+    for (Size i = 0; i < count; ++i) {
+      *result++ = *first++;
+    }
+    return result;
+  }
+
   template <typename T>
   constexpr auto& clamp(const T& v, const T& min, const T& max) {
     return v < min ? min : max < v ? max : v;
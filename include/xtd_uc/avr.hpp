@@ -11,11 +11,22 @@
 #include <stdio.h>
 #endif
 
+#include <stdint.h>
+
 // Make clang tooling shut up
 #ifndef PSTR
 #define PSTR(x) x
 #endif
 
+// Program memory is ordinary memory when not building for AVR
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+
+#ifndef pgm_read_byte
+#define pgm_read_byte(addr) (*reinterpret_cast<const uint8_t*>(addr))
+#endif
+
 namespace xtd {
   // A simple wrapper to allow function overloading on program memory strings
   // and normal strings.
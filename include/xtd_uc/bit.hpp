@@ -0,0 +1,64 @@
+#ifndef XTD_UC_BIT_HPP
+#define XTD_UC_BIT_HPP
+#include "common.hpp"
+
+#include "avr.hpp"
+#include "cstdint.hpp"
+
+namespace xtd {
+  namespace detail {
+    // The number of trailing zero bits for every `bits` wide value, computed at compile time.
+    template <uint8_t bits>
+    struct countr_zero_table {
+      uint8_t value[1 << bits];
+
+      constexpr countr_zero_table() : value() {
+        value[0] = bits;
+        for (int i = 1; i < (1 << bits); ++i) {
+          uint8_t n = 0;
+          while (((i >> n) & 1) == 0) {
+            ++n;
+          }
+          value[i] = n;
+        }
+      }
+    };
+
+    template <uint8_t bits>
+    struct countr_zero_lut {
+      static_assert(bits >= 1 && bits <= 8, "Table must be indexed by at most one byte!");
+      static const countr_zero_table<bits> table;
+    };
+
+    template <uint8_t bits>
+    const countr_zero_table<bits> countr_zero_lut<bits>::table PROGMEM = countr_zero_table<bits>();
+  }  // namespace detail
+
+  // Returns the number of consecutive zero bits in the `bits` low bits of x, starting from the
+  // least significant bit. Returns `bits` if they are all zero. The upper bits of x must be zero.
+  //
+  // This is a single read from a 2^bits byte table in program memory, so keep `bits` small.
+  template <uint8_t bits>
+  inline uint8_t countr_zero_bits(uint8_t x) {
+    return pgm_read_byte(&detail::countr_zero_lut<bits>::table.value[x]);
+  }
+
+  // Returns the number of consecutive zero bits in x, starting from the least significant bit.
+  // Returns the width of x in bits if x is zero.
+  inline uint8_t countr_zero(uint8_t x) {
+    const uint8_t low = x & 0x0F;
+    return low ? countr_zero_bits<4>(low) : uint8_t(4 + countr_zero_bits<4>(uint8_t(x >> 4)));
+  }
+
+  inline uint8_t countr_zero(uint16_t x) {
+    const auto low = static_cast<uint8_t>(x);
+    return low ? countr_zero(low) : uint8_t(8 + countr_zero(static_cast<uint8_t>(x >> 8)));
+  }
+
+  inline uint8_t countr_zero(uint32_t x) {
+    const auto low = static_cast<uint16_t>(x);
+    return low ? countr_zero(low) : uint8_t(16 + countr_zero(static_cast<uint16_t>(x >> 16)));
+  }
+}  // namespace xtd
+
+#endif
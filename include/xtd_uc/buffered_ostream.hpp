@@ -0,0 +1,86 @@
+#ifndef XTD_UC_BUFFERED_OSTREAM_HPP
+#define XTD_UC_BUFFERED_OSTREAM_HPP
+#include "common.hpp"
+
+#include "cstdint.hpp"
+#include "ostream.hpp"
+
+namespace xtd {
+  template <typename stream_tag, uint8_t N>
+  struct buffered_tag {};
+
+  namespace detail {
+    // Bulk write if the stream has `write(const char*, size)`, one put() per character otherwise.
+    template <typename stream_tag>
+    auto ostream_write(ostream<stream_tag>& os, const char* data, uint8_t len, int)
+        -> decltype(os.write(data, len), void()) {
+      os.write(data, len);
+    }
+
+    template <typename stream_tag>
+    void ostream_write(ostream<stream_tag>& os, const char* data, uint8_t len, long) {
+      for (uint8_t i = 0; i < len; ++i) {
+        os.put(data[i]);
+      }
+    }
+
+    // Floats printed to the buffered stream use the precision of the underlying stream.
+    template <typename stream_tag, uint8_t N>
+    struct ostream_state<buffered_tag<stream_tag, N>> : ostream_state<stream_tag> {};
+  }  // namespace detail
+
+  // Collects output in a buffer of N characters and hands it to the underlying stream in one bulk
+  // write() when the buffer is full, on newline, on flush() and when destroyed. Streams without a
+  // write() member get one put() per character, which still batches the output of a message.
+  //
+  // For the UART this means one copy into the TX queue and one enable of the UDRE interrupt per
+  // line rather than per character.
+  //
+  // Example:
+  //     xtd::ostream<xtd::uart_stream_tag> uart;
+  //
+  //     void report() {
+  //       xtd::buffered_ostream<xtd::uart_stream_tag> out(uart);
+  //       out << "adc: " << value << "\r\n";
+  //     }
+  template <typename stream_tag, uint8_t N>
+  class ostream<buffered_tag<stream_tag, N>> {
+  public:
+    static_assert(N > 0, "The buffer must hold at least one character!");
+
+    explicit ostream(ostream<stream_tag>& os) : m_os(os) {}
+    ostream(const ostream&) = delete;
+    ostream& operator=(const ostream&) = delete;
+    ~ostream() { flush(); }
+
+    void put(char c) {
+      m_buffer[m_len++] = c;
+      if (m_len == N || c == '\n') {
+        flush();
+      }
+    }
+
+    void write(const char* data, size_t len) {
+      while (len--) {
+        put(*data++);
+      }
+    }
+
+    void flush() {
+      if (m_len) {
+        detail::ostream_write(m_os, m_buffer, m_len, 0);
+        m_len = 0;
+      }
+    }
+
+  private:
+    ostream<stream_tag>& m_os;
+    char m_buffer[N];
+    uint8_t m_len = 0;
+  };
+
+  template <typename stream_tag, uint8_t N = 32>
+  using buffered_ostream = ostream<buffered_tag<stream_tag, N>>;
+}  // namespace xtd
+
+#endif
@@ -29,9 +29,9 @@ namespace xtd {
     //
     // Implementation:
     //     The steady_clock is implemented using the TIMER/COUNTER2 on the MCU driven by interrupts.
-    //     We choose TIMER/COUNTER2 because as opposed to timer 0 or 1 TIMER/COUNTER2 stays enabled
-    //     during SLEEP_MODE_POWERSAVE and allows time to pass when the MCU is in power saving
-    //     sleep.
+    //     We choose TIMER/COUNTER2 because as opposed to timer 0 or 1 TIMER/COUNTER2 can be
+    //     clocked asynchronously (ASSR.AS2) and then stays enabled during SLEEP_MODE_PWR_SAVE. It
+    //     is clocked from the I/O clock by default, which only runs in SLEEP_MODE_IDLE.
     //
     // Clock precision:
     //     The clock precision is 1024 / F_CPU seconds. For a 16MHz clock this is 64µs.
@@ -42,7 +42,8 @@ namespace xtd {
     //
     //     To guarantee the accuracy of the clock the following conditions must be fullfilled:
     //         * All ISRs must complete in less than 1024*256 cycles.
-    //         * No other sleep mode than SLEEP_MODE_IDLE or SLEEP_MODE_POWERSAVE may be used.
+    //         * No other sleep mode than SLEEP_MODE_IDLE may be used, or SLEEP_MODE_PWR_SAVE if
+    //           TIMER2 is clocked asynchronously.
     //         * Global interrupts must be enabled as default and interrupts may not be disabled
     //           for more than or equal to 256*1024 cycles.
     //
@@ -66,6 +67,17 @@ namespace xtd {
       constexpr static bool is_steady = true;
       static time_point now();
 
+      // Arms a one-shot TIMER/COUNTER2 compare match interrupt at the time point `t`, so that a
+      // sleeping MCU wakes up on time instead of at the next overflow interrupt.
+      //
+      // Only time points within the current overflow period can be armed as the hardware only
+      // holds the low byte of the tick count, false is returned for any other time point. Time
+      // points further away are reached through the overflow interrupt which wakes the MCU
+      // anyway, so simply call this again after waking up.
+      //
+      // Must be called with global interrupts disabled.
+      static bool wake_at(const time_point& t);
+
     private:
       steady_clock();
 #ifndef ENABLE_TEST
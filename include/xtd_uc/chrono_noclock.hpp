@@ -138,6 +138,34 @@ namespace xtd {
   }  // namespace chrono
 
   namespace units {
+    // Prints the duration as "hh:mm:ss.mmm", the same format as the std::ostream overload below.
+    // Must be in the same namespace as quantity, see below.
+    template <typename stream_tag, typename R, typename P>
+    xtd::ostream<stream_tag>& operator<<(xtd::ostream<stream_tag>& os,
+                                         const chrono::duration<R, P>& d) {
+      using namespace chrono;
+      if (d.count() < 0) {
+        os.put('-');
+        return os << -d;
+      }
+      const auto h = ratio_convert<hours::scale, P>(d.count());
+      auto rh = d - hours(h);
+      const auto m = ratio_convert<minutes::scale, typename decltype(rh)::scale>(rh.count());
+      auto rm = rh - minutes(m);
+      const auto s = ratio_convert<seconds::scale, typename decltype(rm)::scale>(rm.count());
+      auto rs = rm - seconds(s);
+      const auto ms = ratio_convert<milliseconds::scale, typename decltype(rs)::scale>(rs.count());
+
+      xtd::detail::put_decimal(os, uint32_t(h), 2);
+      os.put(':');
+      xtd::detail::put_decimal(os, uint8_t(m), 2);
+      os.put(':');
+      xtd::detail::put_decimal(os, uint8_t(s), 2);
+      os.put('.');
+      xtd::detail::put_decimal(os, uint16_t(ms), 3);
+      return os;
+    }
+
 #ifdef HAS_STL
     // This overload must be in the same namespace as xtd::units::quantity of which
     // duration is an alias. Otherwise this overload will not be found through ADL.
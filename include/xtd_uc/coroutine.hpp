@@ -0,0 +1,266 @@
+#ifndef XTD_UC_COROUTINE_HPP
+#define XTD_UC_COROUTINE_HPP
+#include "common.hpp"
+
+#include "chrono.hpp"
+#include "cstdint.hpp"
+#include "type_traits.hpp"
+#include "utility.hpp"
+
+#ifdef ENABLE_TEST
+#include "fake_avr.hpp"
+#else
+#include <util/atomic.h>
+#endif
+
+// -----------------------------------------------------------------------------
+//
+// Stackless coroutines (protothreads) that run as scheduler tasks.
+//
+// A coroutine is a function returning xtd::co_result whose body is wrapped in
+// XTD_CO_BEGIN/XTD_CO_END. Each call to the function resumes the coroutine from
+// where it last suspended. The only state kept between calls is the resume
+// point, an xtd::coroutine which is 2 bytes. This allows many concurrent
+// protocol flows without a stack per flow.
+//
+// Example:
+//     xtd::timer_scheduler<8, 4> scheduler;
+//     volatile bool conversion_done;
+//
+//     xtd::co_result read_sensor() {
+//       static xtd::coroutine co;
+//       XTD_CO_BEGIN(co);
+//       while (true) {
+//         start_conversion();
+//         XTD_CO_AWAIT(co, conversion_done);  // ISR calls sensor_task::wake()
+//         conversion_done = false;
+//         publish(read_result());
+//         XTD_CO_SLEEP_FOR(co, 100_ms);
+//       }
+//       XTD_CO_END(co);
+//     }
+//
+//     using sensor_task = xtd::co_task<decltype(scheduler), scheduler, read_sensor>;
+//
+//     int main() {
+//       sensor_task::wake();
+//       scheduler.run();
+//     }
+//
+// CAUTION: Local variables are NOT preserved across suspension points, as the
+// function returns each time the coroutine suspends. Use static variables or
+// data members of a struct that outlives the coroutine instead. For the same
+// reason the suspension macros may not be used inside a switch statement in the
+// coroutine body.
+//
+// The resume point is a uint16_t, so a translation unit may use the suspension
+// macros fewer than 65535 times in total.
+//
+// -----------------------------------------------------------------------------
+
+#if defined(__has_attribute)
+#if __has_attribute(fallthrough)
+#define XTD_CO_FALLTHROUGH __attribute__((fallthrough))
+#endif
+#endif
+#ifndef XTD_CO_FALLTHROUGH
+#define XTD_CO_FALLTHROUGH \
+  do {                     \
+  } while (0)
+#endif
+
+// Starts the body of the coroutine `co`, resumes from the last suspension point.
+#define XTD_CO_BEGIN(co) \
+  switch ((co).m_line) { \
+    case 0:
+
+// Ends the body of the coroutine `co`. Resuming a finished coroutine does nothing.
+#define XTD_CO_END(co)                      \
+  }                                         \
+  (co).m_line = ::xtd::coroutine::finished; \
+  return ::xtd::co_result{::xtd::co_action::done, {}}
+
+// Suspends the coroutine and lets other tasks run before it is resumed.
+#define XTD_CO_YIELD(co) XTD_CO_YIELD_(co, __COUNTER__ + 1)
+
+// Suspends the coroutine until `cond` is true. The condition is checked each time the coroutine
+// is woken up, typically by an ISR calling co_task<...>::wake() after the event happened.
+#define XTD_CO_AWAIT(co, cond) XTD_CO_AWAIT_(co, cond, __COUNTER__ + 1)
+
+// Suspends the coroutine for the given duration.
+#define XTD_CO_SLEEP_FOR(co, d) XTD_CO_SLEEP_FOR_(co, d, __COUNTER__ + 1)
+
+// The resume points are numbered with __COUNTER__ rather than __LINE__ so that several
+// suspension points may share a line.
+#define XTD_CO_YIELD_(co, n)                              \
+  do {                                                    \
+    (co).m_line = (n);                                    \
+    return ::xtd::co_result{::xtd::co_action::yield, {}}; \
+    case (n):;                                            \
+  } while (0)
+
+#define XTD_CO_AWAIT_(co, cond, n)                           \
+  do {                                                       \
+    (co).m_line = (n);                                       \
+    XTD_CO_FALLTHROUGH;                                      \
+    case (n):                                                \
+      if (!(cond)) {                                         \
+        return ::xtd::co_result{::xtd::co_action::wait, {}}; \
+      }                                                      \
+  } while (0)
+
+#define XTD_CO_SLEEP_FOR_(co, d, n)                      \
+  do {                                                   \
+    (co).m_line = (n);                                   \
+    return ::xtd::co_result{::xtd::co_action::sleep, d}; \
+    case (n):;                                           \
+  } while (0)
+
+namespace xtd {
+  // What the scheduler should do with a coroutine that returned from a resume.
+  enum class co_action : uint8_t {
+    yield,  // Resume again as soon as possible
+    wait,   // Resume when woken up
+    sleep,  // Resume after co_result::delay
+    done    // The coroutine has finished
+  };
+
+  struct co_result {
+    co_action action;
+    chrono::steady_clock::duration delay;
+  };
+
+  // The resume point of a stackless coroutine, see the macros above.
+  class coroutine {
+  public:
+    constexpr static uint16_t finished = 0xFFFF;
+
+    bool done() const { return m_line == finished; }
+
+    // Restarts the coroutine from the beginning on the next resume.
+    void reset() { m_line = 0; }
+
+    // Only to be used through the XTD_CO_* macros
+    uint16_t m_line = 0;
+  };
+
+  namespace detail {
+    template <typename Scheduler, typename = void>
+    struct co_has_timers : false_type {};
+
+    template <typename Scheduler>
+    struct co_has_timers<Scheduler, decltype(void(declval<Scheduler&>().schedule_after(
+                                        chrono::steady_clock::duration(), nullptr)))>
+        : true_type {};
+  }  // namespace detail
+
+  // Runs the coroutine `step` as a task on the scheduler `sched`.
+  //
+  // The scheduler must offer `schedule(task)`, such as fcfs_scheduler, and should preferably also
+  // offer `schedule_after(duration, task)`, such as timer_scheduler. With the latter the MCU
+  // sleeps while the coroutine sleeps. With the former a sleeping coroutine is polled by
+  // re-scheduling it until the steady_clock has passed its wake up time, which keeps the MCU
+  // awake.
+  //
+  // The coroutine is in the scheduler at most once. Waking it up while it is already scheduled,
+  // yielded or sleeping does nothing, so a sleep always lasts its full duration. Waking it up
+  // while it runs resumes it again afterwards if it then awaits, so no event is lost.
+  //
+  // If the scheduler is overloaded when a coroutine yields or sleeps, the coroutine is dropped
+  // and must be woken up again. Size the scheduler queue for the number of coroutines.
+  template <typename Scheduler, Scheduler& sched, co_result (*step)()>
+  class co_task {
+  public:
+    co_task() = delete;
+
+    // Schedules the coroutine to be resumed unless it already is. Use this to start the
+    // coroutine and to wake it up when the event it awaits has happened.
+    // Returns false if the coroutine wasn't admitted due to overload.
+    // May be called safely from ISRs.
+    static bool wake() {
+      bool admitted = true;
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (s_state == state::idle) {
+          admitted = resume();
+        } else if (s_state == state::running) {
+          s_state = state::woken;
+        }
+      }
+      return admitted;
+    }
+
+    // The scheduler task, resumes the coroutine once.
+    static void run() {
+      if (!ready(has_timers())) {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { resume(); }
+        return;
+      }
+
+      s_state = state::running;
+      const auto r = step();
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        const bool woken = s_state == state::woken;
+        s_state = state::idle;
+        switch (r.action) {
+          case co_action::yield:
+            resume();
+            break;
+          case co_action::sleep:
+            if (sleep_for(r.delay, has_timers())) {
+              s_state = state::scheduled;
+            }
+            break;
+          case co_action::wait:
+            if (woken) {
+              resume();
+            }
+            break;
+          case co_action::done:
+            break;
+        }
+      }
+    }
+
+  private:
+    using has_timers = detail::co_has_timers<Scheduler>;
+    using time_point = chrono::steady_clock::time_point;
+
+    enum class state : uint8_t {
+      idle,       // Not in the scheduler, waiting to be woken up
+      scheduled,  // In the ready queue or the timer table
+      running,    // In step()
+      woken       // In step() and wake() has been called since it started
+    };
+
+    // Must be called with interrupts disabled.
+    static bool resume() {
+      const bool admitted = sched.schedule(&run);
+      s_state = admitted ? state::scheduled : state::idle;
+      return admitted;
+    }
+
+    static bool sleep_for(const chrono::steady_clock::duration& d, true_type) {
+      return sched.schedule_after(d, &run);
+    }
+
+    static bool sleep_for(const chrono::steady_clock::duration& d, false_type) {
+      s_wake_up = time_point(chrono::steady_clock::now().time_since_epoch() + d);
+      return sched.schedule(&run);
+    }
+
+    static bool ready(true_type) { return true; }
+    static bool ready(false_type) { return !(chrono::steady_clock::now() < s_wake_up); }
+
+    static volatile state s_state;
+    static time_point s_wake_up;  // Only used by schedulers without timers
+  };
+
+  template <typename Scheduler, Scheduler& sched, co_result (*step)()>
+  volatile typename co_task<Scheduler, sched, step>::state co_task<Scheduler, sched, step>::s_state =
+      co_task<Scheduler, sched, step>::state::idle;
+
+  template <typename Scheduler, Scheduler& sched, co_result (*step)()>
+  typename co_task<Scheduler, sched, step>::time_point co_task<Scheduler, sched, step>::s_wake_up;
+}  // namespace xtd
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef XTD_UC_CRC_HPP
+#define XTD_UC_CRC_HPP
+#include "common.hpp"
+
+#include "cstdint.hpp"
+
+namespace xtd {
+  // CRC-16/CCITT-FALSE: polynomial 0x1021, initial value 0xFFFF, not reflected, no final XOR.
+  // The check value for "123456789" is 0x29B1.
+  //
+  // Appending the CRC to the data, most significant byte first, and running the CRC over the
+  // whole lot yields zero. This lets a receiver check a frame as it arrives without knowing where
+  // the data ends and the CRC starts.
+  class crc16_ccitt {
+  public:
+    using value_type = uint16_t;
+
+    constexpr static value_type initial = 0xFFFF;
+
+    // Updates the CRC with one byte. Table free and branch free, this is a handful of shifts and
+    // XORs which is both smaller and, on AVR, about as fast as a 512 byte lookup table.
+    constexpr static value_type update(value_type crc, uint8_t data) {
+      return update_x(crc, uint8_t(uint8_t(crc >> 8) ^ data));
+    }
+
+    void put(uint8_t data) { m_crc = update(m_crc, data); }
+
+    void write(const uint8_t* data, size_t len) {
+      while (len--) {
+        put(*data++);
+      }
+    }
+
+    void reset() { m_crc = initial; }
+    value_type value() const { return m_crc; }
+
+  private:
+    constexpr static value_type update_x(value_type crc, uint8_t x) {
+      return update_xx(crc, uint8_t(x ^ (x >> 4)));
+    }
+
+    constexpr static value_type update_xx(value_type crc, uint8_t x) {
+      return value_type((crc << 8) ^ (value_type(x) << 12) ^ (value_type(x) << 5) ^ x);
+    }
+
+    value_type m_crc = initial;
+  };
+}  // namespace xtd
+
+#endif
@@ -45,6 +45,75 @@ constexpr uint8_t UPRSMI = 6;
 
 constexpr uint8_t FRZCLK = 5;
 
-uint8_t _BV(int x) { return (1 << x); }
+// USART, two instances with the ATmega328PB register layout.
+EXTERN volatile uint8_t UCSR0A INITIALIZE;
+EXTERN volatile uint8_t UCSR0B INITIALIZE;
+EXTERN volatile uint8_t UCSR0C INITIALIZE;
+EXTERN volatile uint16_t UBRR0 INITIALIZE;
+EXTERN volatile uint8_t UDR0 INITIALIZE;
+EXTERN volatile uint8_t UCSR1A INITIALIZE;
+EXTERN volatile uint8_t UCSR1B INITIALIZE;
+EXTERN volatile uint8_t UCSR1C INITIALIZE;
+EXTERN volatile uint16_t UBRR1 INITIALIZE;
+EXTERN volatile uint8_t UDR1 INITIALIZE;
+
+constexpr uint8_t RXC0 = 7;
+constexpr uint8_t TXC0 = 6;
+constexpr uint8_t UDRE0 = 5;
+constexpr uint8_t FE0 = 4;
+constexpr uint8_t DOR0 = 3;
+constexpr uint8_t UPE0 = 2;
+constexpr uint8_t U2X0 = 1;
+constexpr uint8_t MPCM0 = 0;
+
+constexpr uint8_t RXCIE0 = 7;
+constexpr uint8_t TXCIE0 = 6;
+constexpr uint8_t UDRIE0 = 5;
+constexpr uint8_t RXEN0 = 4;
+constexpr uint8_t TXEN0 = 3;
+constexpr uint8_t UCSZ02 = 2;
+constexpr uint8_t RXB80 = 1;
+constexpr uint8_t TXB80 = 0;
+
+constexpr uint8_t UMSEL00 = 6;
+constexpr uint8_t UPM00 = 4;
+constexpr uint8_t USBS0 = 3;
+constexpr uint8_t UCSZ00 = 1;
+
+// Power reduction
+EXTERN volatile uint8_t PRR INITIALIZE;  // PRR0 on the 328PB
+
+constexpr uint8_t PRUSART0 = 1;
+constexpr uint8_t PRUSART1 = 4;
+
+// Asynchronous status register of TIMER2
+EXTERN volatile uint8_t ASSR INITIALIZE;
+
+constexpr uint8_t AS2 = 5;
+constexpr uint8_t TCN2UB = 4;
+constexpr uint8_t OCR2AUB = 3;
+constexpr uint8_t OCR2BUB = 2;
+constexpr uint8_t TCR2AUB = 1;
+constexpr uint8_t TCR2BUB = 0;
+
+// Interrupts and sleep, the fakes do nothing.
+#define ATOMIC_BLOCK(type) \
+  for (bool xtd_fake_atomic = true; xtd_fake_atomic; xtd_fake_atomic = false)
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_FORCEON
+
+constexpr uint8_t SLEEP_MODE_IDLE = 0;
+constexpr uint8_t SLEEP_MODE_ADC = 2;
+constexpr uint8_t SLEEP_MODE_PWR_DOWN = 4;
+constexpr uint8_t SLEEP_MODE_PWR_SAVE = 6;
+
+inline void cli() {}
+inline void sei() {}
+inline void set_sleep_mode(uint8_t) {}
+inline void sleep_enable() {}
+inline void sleep_disable() {}
+inline void sleep_cpu() {}
+
+constexpr uint8_t _BV(int x) { return uint8_t(1 << x); }
 
 #endif
@@ -0,0 +1,386 @@
+#ifndef XTD_UC_FORMAT_HPP
+#define XTD_UC_FORMAT_HPP
+#include "common.hpp"
+
+#include "avr.hpp"
+#include "cstdint.hpp"
+#include "ostream.hpp"
+#include "type_traits.hpp"
+
+// Defines a format string for xtd::format(). The string is stored in program memory and is
+// parsed at compile time to check it against the arguments.
+//
+// Each `{}` is replaced by the next argument, `{{` and `}}` print a literal brace. A placeholder
+// may have a specification: `{:[fill][width][.precision][type]}` where
+//
+//   fill       A character to pad with up to width, a space by default. A width starting with 0
+//              pads with zeros after the sign, e.g. {:08x}. Any other fill character must be
+//              followed by the width, e.g. {:*8}.
+//   width      The minimum number of characters, the argument is right aligned.
+//   .precision The number of decimals of a float, defaults to that of the stream.
+//   type       d for decimal (the default), x or X for hexadecimal and b for binary. Only
+//              integers may be printed as hexadecimal and binary. Negative values are printed
+//              as a '-' and their magnitude.
+//
+// Example:
+//     xtd::format(uart, XTD_FMT("adc{}: {:5} raw={:04X} {:.2} V\r\n"), ch, value, value, volts);
+//
+// The macro yields an object of a unique type that carries the string. It must be used inside a
+// function, like PSTR().
+#define XTD_FMT(str)                                         \
+  [] {                                                       \
+    struct xtd_fmt {                                         \
+      constexpr static const char* literal() { return str; } \
+      static const char* pgm() {                             \
+        static const char s[] PROGMEM = str;                 \
+        return s;                                            \
+      }                                                      \
+    };                                                       \
+    return xtd_fmt{};                                        \
+  }()
+
+namespace xtd {
+  namespace detail {
+    enum class format_kind : uint8_t {
+      none,
+      boolean,
+      character,
+      signed32,
+      unsigned32,
+      signed64,
+      unsigned64,
+      floating,
+      string,
+      pstring
+    };
+
+    template <typename T, typename Enable = void>
+    struct format_kind_of : integral_constant<format_kind, format_kind::none> {};
+
+    template <typename T>
+    struct format_kind_of<T, enable_if_t<is_integral<T>::value>>
+        : integral_constant<format_kind, is_signed<T>::value
+                                             ? (sizeof(T) <= 4 ? format_kind::signed32
+                                                               : format_kind::signed64)
+                                             : (sizeof(T) <= 4 ? format_kind::unsigned32
+                                                               : format_kind::unsigned64)> {};
+
+    template <>
+    struct format_kind_of<bool> : integral_constant<format_kind, format_kind::boolean> {};
+    template <>
+    struct format_kind_of<char> : integral_constant<format_kind, format_kind::character> {};
+    template <>
+    struct format_kind_of<float> : integral_constant<format_kind, format_kind::floating> {};
+    template <>
+    struct format_kind_of<double> : integral_constant<format_kind, format_kind::floating> {};
+    template <>
+    struct format_kind_of<const char*> : integral_constant<format_kind, format_kind::string> {};
+    template <>
+    struct format_kind_of<char*> : integral_constant<format_kind, format_kind::string> {};
+    template <size_t n>
+    struct format_kind_of<char[n]> : integral_constant<format_kind, format_kind::string> {};
+    template <>
+    struct format_kind_of<pstr> : integral_constant<format_kind, format_kind::pstring> {};
+
+    constexpr bool format_is_integer(format_kind k) {
+      return k == format_kind::signed32 || k == format_kind::unsigned32 ||
+             k == format_kind::signed64 || k == format_kind::unsigned64;
+    }
+
+    // A type erased argument, so that the interpreter is instantiated once per stream rather
+    // than once per combination of argument types.
+    struct format_arg {
+      format_kind kind = format_kind::none;
+      union {
+        int32_t i32;
+        uint32_t u32;
+        int64_t i64;
+        uint64_t u64;
+        float f;
+        const char* s;
+      };
+
+      format_arg() : u64(0) {}
+      format_arg(bool v) : kind(format_kind::boolean), u32(v) {}
+      format_arg(char v) : kind(format_kind::character), u32(uint8_t(v)) {}
+      format_arg(double v) : kind(format_kind::floating), f(float(v)) {}
+      format_arg(const char* v) : kind(format_kind::string), s(v) {}
+      format_arg(pstr v) : kind(format_kind::pstring), s(v.str) {}
+
+      template <typename T, enable_if_t<format_is_integer(format_kind_of<T>::value), int> = 0>
+      format_arg(T v) : kind(format_kind_of<T>::value) {
+        if (kind == format_kind::signed32) {
+          i32 = int32_t(v);
+        } else if (kind == format_kind::unsigned32) {
+          u32 = uint32_t(v);
+        } else if (kind == format_kind::signed64) {
+          i64 = int64_t(v);
+        } else {
+          u64 = uint64_t(v);
+        }
+      }
+    };
+
+    struct format_spec {
+      char fill = ' ';
+      uint8_t width = 0;
+      uint8_t precision = 0xFF;  // Use the precision of the stream
+      char type = 'd';
+    };
+
+    struct format_literal_reader {
+      constexpr char operator()(const char* p) const { return *p; }
+    };
+
+    struct format_pgm_reader {
+      char operator()(const char* p) const { return char(pgm_read_byte(p)); }
+    };
+
+    constexpr bool format_is_digit(char c) { return c >= '0' && c <= '9'; }
+
+    // Parses the placeholder that starts after the '{' at p. Returns a pointer past the closing
+    // '}', or nullptr if the placeholder is malformed. Shared by the compile time check and the
+    // run time interpreter, that reads from program memory.
+    template <typename Read>
+    constexpr const char* format_parse_spec(const char* p, format_spec& spec, Read read) {
+      if (read(p) == ':') {
+        p++;
+        const char c = read(p);
+        if (c == '0' || (c != '}' && c != '.' && !format_is_digit(c) &&
+                         format_is_digit(read(p + 1)))) {
+          spec.fill = c;
+          p++;
+        }
+        while (format_is_digit(read(p))) {
+          spec.width = uint8_t(spec.width * 10 + (read(p++) - '0'));
+        }
+        if (read(p) == '.') {
+          p++;
+          if (!format_is_digit(read(p))) {
+            return nullptr;
+          }
+          spec.precision = 0;
+          while (format_is_digit(read(p))) {
+            spec.precision = uint8_t(spec.precision * 10 + (read(p++) - '0'));
+          }
+        }
+        const char t = read(p);
+        if (t == 'd' || t == 'x' || t == 'X' || t == 'b') {
+          spec.type = t;
+          p++;
+        }
+      }
+      return read(p) == '}' ? p + 1 : nullptr;
+    }
+
+    enum class format_error : uint8_t {
+      ok,
+      syntax,
+      too_few_args,
+      too_many_args,
+      type,
+      unsupported
+    };
+
+    // Checks the format string against the kinds of the n arguments at compile time.
+    constexpr format_error format_validate(const char* f, const format_kind* kinds, uint8_t n) {
+      for (uint8_t i = 0; i < n; ++i) {
+        if (kinds[i] == format_kind::none) {
+          return format_error::unsupported;
+        }
+      }
+      uint8_t next = 0;
+      while (*f) {
+        const char c = *f++;
+        if (c == '{') {
+          if (*f == '{') {
+            f++;
+            continue;
+          }
+          format_spec spec;
+          f = format_parse_spec(f, spec, format_literal_reader());
+          if (!f) {
+            return format_error::syntax;
+          }
+          if (next == n) {
+            return format_error::too_few_args;
+          }
+          if (spec.type != 'd' && !format_is_integer(kinds[next])) {
+            return format_error::type;
+          }
+          next++;
+        } else if (c == '}') {
+          if (*f++ != '}') {
+            return format_error::syntax;
+          }
+        }
+      }
+      return next == n ? format_error::ok : format_error::too_many_args;
+    }
+
+    // Where numbers are formatted so that they can be padded to width.
+    struct format_buffer_tag {};
+  }  // namespace detail
+
+  template <>
+  class ostream<detail::format_buffer_tag> {
+  public:
+    void put(char c) {
+      if (len < sizeof(buf)) {
+        buf[len++] = c;
+      }
+    }
+
+    char buf[66];  // 64 binary digits and a sign
+    uint8_t len = 0;
+  };
+
+  namespace detail {
+    // Writes the digits of v in base 2^bits, without division.
+    template <typename U>
+    void format_radix(ostream<format_buffer_tag>& os, U v, uint8_t bits, bool upper) {
+      const uint8_t mask = uint8_t((1 << bits) - 1);
+      int8_t shift = int8_t(sizeof(U) * 8 - (sizeof(U) * 8) % bits);
+      if (shift == int8_t(sizeof(U) * 8)) {
+        shift = int8_t(shift - bits);
+      }
+      bool leading = true;
+      for (; shift >= 0; shift = int8_t(shift - bits)) {
+        const uint8_t d = uint8_t(v >> shift) & mask;
+        if (d == 0 && leading && shift != 0) {
+          continue;
+        }
+        leading = false;
+        os.put(char(d < 10 ? '0' + d : (upper ? 'A' : 'a') + d - 10));
+      }
+    }
+
+    template <typename S, typename U>
+    void format_integer(ostream<format_buffer_tag>& os, S v, bool is_signed, char type) {
+      U magnitude = U(v);
+      if (is_signed && v < 0) {
+        os.put('-');
+        magnitude = U(~magnitude + 1);
+      }
+      if (type == 'x' || type == 'X') {
+        format_radix(os, magnitude, 4, type == 'X');
+      } else if (type == 'b') {
+        format_radix(os, magnitude, 1, false);
+      } else {
+        put_decimal(os, magnitude);
+      }
+    }
+
+    template <typename stream_tag>
+    void format_pad(ostream<stream_tag>& os, const format_spec& spec, uint8_t len) {
+      for (uint8_t i = len; i < spec.width; ++i) {
+        os.put(spec.fill);
+      }
+    }
+
+    template <typename stream_tag>
+    void format_put(ostream<stream_tag>& os, const format_arg& arg, const format_spec& spec) {
+      if (arg.kind == format_kind::string || arg.kind == format_kind::pstring) {
+        const bool progmem = arg.kind == format_kind::pstring;
+        uint8_t len = 0;
+        while ((progmem ? pgm_read_byte(arg.s + len) : arg.s[len]) && len < spec.width) {
+          len++;
+        }
+        format_pad(os, spec, len);
+        if (progmem) {
+          os << pstr(arg.s);
+        } else {
+          os << arg.s;
+        }
+        return;
+      }
+
+      ostream<format_buffer_tag> buf;
+      switch (arg.kind) {
+        case format_kind::boolean:
+          buf << bool(arg.u32);
+          break;
+        case format_kind::character:
+          buf.put(char(arg.u32));
+          break;
+        case format_kind::signed32:
+          format_integer<int32_t, uint32_t>(buf, arg.i32, true, spec.type);
+          break;
+        case format_kind::unsigned32:
+          format_integer<uint32_t, uint32_t>(buf, arg.u32, false, spec.type);
+          break;
+        case format_kind::signed64:
+          format_integer<int64_t, uint64_t>(buf, arg.i64, true, spec.type);
+          break;
+        case format_kind::unsigned64:
+          format_integer<uint64_t, uint64_t>(buf, arg.u64, false, spec.type);
+          break;
+        case format_kind::floating:
+          ostream_state<format_buffer_tag>::precision =
+              spec.precision <= max_precision ? spec.precision
+                                              : ostream_state<stream_tag>::precision;
+          buf << arg.f;
+          break;
+        default:
+          break;
+      }
+      uint8_t i = 0;
+      if (spec.fill == '0' && arg.kind != format_kind::character && buf.len > 0 &&
+          buf.buf[0] == '-') {
+        os.put(buf.buf[i++]);  // Zeros go between the sign and the digits
+      }
+      format_pad(os, spec, buf.len);
+      for (; i < buf.len; ++i) {
+        os.put(buf.buf[i]);
+      }
+    }
+
+    // The run time interpreter, fmt is in program memory and has been validated at compile time.
+    template <typename stream_tag>
+    void vformat(ostream<stream_tag>& os, const char* fmt, const format_arg* args) {
+      while (const char c = char(pgm_read_byte(fmt++))) {
+        if (c == '{') {
+          if (pgm_read_byte(fmt) == '{') {
+            fmt++;
+            os.put('{');
+          } else {
+            format_spec spec;
+            fmt = format_parse_spec(fmt, spec, format_pgm_reader());
+            format_put(os, *args++, spec);
+          }
+        } else if (c == '}') {
+          fmt++;
+          os.put('}');
+        } else {
+          os.put(c);
+        }
+      }
+    }
+  }  // namespace detail
+
+  // Prints the arguments to the stream according to the format, which must come from XTD_FMT().
+  // A malformed format, the wrong number of arguments or a hexadecimal or binary placeholder for
+  // an argument that isn't an integer fails to compile.
+  //
+  // Each call site only stores the arguments in an array and makes one call, the formatting is
+  // done by an interpreter that is shared by all formats printed to the same stream type.
+  template <typename stream_tag, typename Format, typename... Args>
+  ostream<stream_tag>& format(ostream<stream_tag>& os, Format, const Args&... args) {
+    using detail::format_error;
+    constexpr detail::format_kind kinds[] = {
+        detail::format_kind_of<Args>::value..., detail::format_kind::none};
+    constexpr format_error error =
+        detail::format_validate(Format::literal(), kinds, uint8_t(sizeof...(Args)));
+    static_assert(error != format_error::syntax, "Malformed format string!");
+    static_assert(error != format_error::too_few_args, "Too few arguments for the format!");
+    static_assert(error != format_error::too_many_args, "Too many arguments for the format!");
+    static_assert(error != format_error::type, "Only integers can be printed as hex or binary!");
+    static_assert(error != format_error::unsupported, "Argument type can't be formatted!");
+
+    const detail::format_arg array[] = {detail::format_arg(args)..., detail::format_arg()};
+    detail::vformat(os, Format::pgm(), array);
+    return os;
+  }
+}  // namespace xtd
+
+#endif
@@ -34,6 +34,16 @@ namespace xtd {
     // repeatedly but will return the same value each time.
     i2c_slave_receive,
 
+    // This device was addressed for a write as a slave, the next i2c_slave_receive is the first
+    // byte of the write. No bus action is needed.
+    i2c_slave_addressed,
+
+    // A write to this device as a slave was terminated by a STOP or a repeated START. No bus
+    // action is needed. The USI flags a STOP (USIPF) but has no interrupt for it, so on ATtiny
+    // this is returned by poll_stop() once it sees the flag, or by on_usi_start() at the next
+    // START on the bus if the STOP wasn't polled.
+    i2c_slave_stop,
+
     // Arbitration lost for master transaction. User can retry transmission later.
     // No bus action is allowed.
     // This device might receive data as a slave from the winner of the arbitration, if that is the
@@ -59,7 +69,8 @@ namespace xtd {
     // One of i2c_device::master_txn/master_release() must be called.
     i2c_master_idle,
 
-    // We do not own the bus and we are not addressed as a slave.
+    // We do not own the bus and we are not addressed as a slave. Also returned on ATmega when a
+    // read from this device as a slave ends, or a write to it ends with a nacked byte.
     i2c_idle,
 
     // The hardware is busy and no action is needed from the user at this point.
@@ -69,6 +80,32 @@ namespace xtd {
     i2c_internal_error
   };
 
+#ifdef __AVR_MEGA__
+  // The TWI bit rate register and prescaler for a SCL frequency, and the frequency achieved.
+  struct i2c_twi_bitrate {
+    uint8_t twbr;
+    uint8_t twps;   // The prescaler is 4^twps
+    uint32_t rate;  // 0 if the requested rate is out of range
+  };
+
+  // Solves SCL = f_cpu / (16 + 2 * TWBR * 4^TWPS) for the fastest rate that doesn't exceed
+  // `bitrate`, using the smallest prescaler that achieves it.
+  constexpr i2c_twi_bitrate i2c_twi_solve(uint32_t f_cpu, uint32_t bitrate) {
+    if (bitrate == 0 || f_cpu < 16 * bitrate) {
+      return {0, 0, 0};
+    }
+    for (uint8_t twps = 0; twps < 4; ++twps) {
+      const uint32_t p2 = uint32_t(2) << (2 * twps);
+      // Round TWBR up so that the rate is never above the requested one.
+      const uint32_t twbr = (f_cpu - 16 * bitrate + p2 * bitrate - 1) / (p2 * bitrate);
+      if (twbr <= 255) {
+        return {uint8_t(twbr), twps, f_cpu / (16 + p2 * twbr)};
+      }
+    }
+    return {0, 0, 0};
+  }
+#endif
+
   // Controlls the I2C hardware on the device.
   //
   // The design is interrupt driven and buffer free, you don't pay for what you don't use.
@@ -85,7 +122,17 @@ namespace xtd {
 
 #if __AVR_ATtiny85__
     // Call this form the USI_START ISR before doing anything else.
-    void on_usi_start();
+    //
+    // Returns i2c_slave_stop if this START terminates a write to this device that poll_stop()
+    // hasn't reported, otherwise i2c_busy.
+    i2c_state on_usi_start();
+
+    // Call this periodically with interrupts disabled, e.g. from a scheduler task, to learn about
+    // the end of a write to this device without waiting for the next START on the bus.
+    //
+    // Returns i2c_slave_stop once after a STOP has terminated a write to this device, otherwise
+    // i2c_busy.
+    i2c_state poll_stop();
     // Call this form the USI_OVF ISR before doing anything else.
     //
     // If the return is i2c_slave_receive exactly one call must be made to either
@@ -125,8 +172,28 @@ namespace xtd {
     bool idle() const;
 
     // Changes the i2c master's signaling rate. The default is standard speed: 100 kbps (100000)
+    // Returns the rate achieved, which is never above the requested one, or 0 if it is out of
+    // range in which case the rate is left unchanged.
+    //
+    // This solves for the register values at runtime with 32 bit divisions, prefer the template
+    // version below unless the rate is only known at runtime.
     uint32_t master_speed(uint32_t bitrate);
 
+#ifdef __AVR_MEGA__
+    // As above but the register values are computed at compile time.
+    //
+    // Example:
+    //     static_assert(xtd::i2c_twi_solve(F_CPU, 400000).rate == 400000, "Inexact SCL!");
+    //     i2c.master_speed<400000>();
+    template <uint32_t bitrate>
+    uint32_t master_speed() {
+      constexpr auto setting = i2c_twi_solve(F_CPU, bitrate);
+      static_assert(setting.rate != 0, "The I2C bitrate is out of range for F_CPU!");
+      set_bitrate(setting.twbr, setting.twps);
+      return setting.rate;
+    }
+#endif
+
     // Starts a master transaction with the given address and data direction.
     // Data transmission is controlled through the i2c_bus_event object returned
     // from on_.*; however it is not necessarily the case that the i2c_bus_event
@@ -171,6 +238,9 @@ namespace xtd {
     void transmit(i2c_data data, bool last_byte);
 
   private:
+#ifdef __AVR_MEGA__
+    void set_bitrate(uint8_t twbr, uint8_t twps);
+#endif
     void expect_bits(uint8_t bits, uint8_t next_state);
     void await_start();
     void read_bits(uint8_t bits, uint8_t next_state);
@@ -180,6 +250,7 @@ namespace xtd {
     i2c_address m_addr = i2c_no_addr;  // 7 bits MSB aligned, LSB is GCE flag
     volatile uint8_t m_next_state = 0;
     volatile bool m_tx_done = false;
+    volatile bool m_rx_active = false;
   };
 
 }  // namespace xtd
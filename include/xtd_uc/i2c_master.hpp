@@ -0,0 +1,258 @@
+#ifndef XTD_UC_I2C_MASTER_HPP
+#define XTD_UC_I2C_MASTER_HPP
+#include "common.hpp"
+
+#include "cstdint.hpp"
+#include "i2c.hpp"
+#include "spsc_queue.hpp"
+
+#ifdef ENABLE_TEST
+#include "fake_avr.hpp"
+#else
+#include <util/atomic.h>
+#endif
+
+namespace xtd {
+  // The outcome of an i2c_transaction.
+  enum class i2c_result : uint8_t {
+    pending,           // Queued or in progress
+    ok,                // All bytes were written and read
+    address_nack,      // Nobody acknowledged the address
+    data_nack,         // The slave did not acknowledge a written byte before the last one
+    arbitration_lost,  // Another master won the bus more than i2c_master_retries times in a row
+  };
+
+  struct i2c_transaction;
+  using i2c_callback = void (*)(i2c_transaction&);
+
+  // A write, a read or a write followed by a repeated start and a read from one slave. The
+  // transaction and the buffers must stay alive until it completes.
+  //
+  // Example, reading two registers from a sensor:
+  //     uint8_t reg = 0x3B;
+  //     uint8_t data[2];
+  //     xtd::i2c_transaction txn{0x68, &reg, 1, data, 2, on_accel_done};
+  struct i2c_transaction {
+    i2c_address address;  // 7 bit address, not shifted
+    const uint8_t* write_data;
+    uint8_t write_len;
+    uint8_t* read_data;
+    uint8_t read_len;
+
+    // Called from the TWI ISR when the transaction is complete, successfully or not. May be null,
+    // may start a new transaction. Keep it short, e.g. post a task to a scheduler.
+    i2c_callback done;
+
+    volatile i2c_result result = i2c_result::pending;
+  };
+
+  // How many times a transaction is restarted when the bus arbitration is lost before it fails
+  // with i2c_result::arbitration_lost.
+  constexpr uint8_t i2c_master_retries = 3;
+
+  // Runs i2c_transactions on the TWI of ATmega devices autonomously from the TWI ISR.
+  //
+  // The engine drives the i2c_device through the i2c_states returned by on_twi(): it sends the
+  // address, writes the bytes, issues a repeated start to switch to reading, acks every byte read
+  // but the last, and sends the stop condition. Arbitration loss restarts the transaction and
+  // a NACK ends it with an error. If the master that won the arbitration addresses this device,
+  // the transaction is restarted once that slave access has ended.
+  //
+  // Up to `max_pending` transactions, a power of two, wait in a queue behind the one in progress.
+  // When a transaction completes the next one is started from the ISR with a repeated start, so
+  // the bus is held and never idles between them; the STOP is only sent when the queue is empty.
+  // Each transaction records its own result and gets its own callback.
+  //
+  // Example:
+  //     xtd::i2c_device i2c;
+  //     xtd::i2c_master<8> master(i2c);
+  //
+  //     ISR(TWI_vect) {
+  //       const auto s = master.on_state(i2c.on_twi());
+  //       // Only slave states are returned, handle them here if the device is also a slave.
+  //     }
+  //
+  //     void on_accel_done(xtd::i2c_transaction& txn) {
+  //       if (txn.result == xtd::i2c_result::ok) {
+  //         scheduler.schedule(process_accel);
+  //       }
+  //     }
+  //
+  //     for (auto& txn : sensor_reads) {
+  //       master.start(txn);
+  //     }
+  //
+  // The Device template parameter is for testing.
+  template <fast_size_t max_pending = 4, typename Device = i2c_device>
+  class i2c_master {
+  public:
+    using size_type = fast_size_t;
+
+    explicit i2c_master(Device& device) : m_device(device) {}
+
+    // Starts the transaction if the engine is idle, otherwise queues it. Returns false if the
+    // queue is full, the transaction is then left untouched.
+    // May be called from any context, including the completion callback.
+    bool start(i2c_transaction& txn) {
+      bool accepted = true;
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (!m_txn) {
+          begin(txn);
+        } else if (m_queue.full()) {
+          accepted = false;
+        } else {
+          txn.result = i2c_result::pending;
+          m_queue.push(&txn);
+        }
+      }
+      return accepted;
+    }
+
+    // True while a transaction is in progress or queued.
+    bool busy() const { return m_txn != nullptr; }
+
+    // The number of transactions waiting behind the one in progress.
+    size_type queued() const { return m_queue.size(); }
+
+    // Call from the TWI ISR with the return value of i2c_device::on_twi(). Master states are
+    // handled and i2c_busy is returned, all other states are returned unchanged for the caller.
+    i2c_state on_state(i2c_state state) {
+      i2c_transaction* const txn = m_txn;
+      if (!txn) {
+        return state;
+      }
+      switch (state) {
+        case i2c_master_lost_arbitration:
+          // The hardware has already released the bus, simply try again once it is free.
+          retry(*txn);
+          break;
+
+        case i2c_master_nobody_home:
+          finish(i2c_result::address_nack, true);
+          break;
+
+        case i2c_master_transmit:  // The address or the last byte was acked
+          if (m_pos < txn->write_len) {
+            const bool last = m_pos + 1 == txn->write_len;
+            m_device.transmit(txn->write_data[m_pos++], last);
+          } else {
+            write_done(*txn);
+          }
+          break;
+
+        case i2c_master_receive:
+          if (m_phase == phase::read_address) {
+            // The address was acked, no data yet.
+            m_phase = phase::reading;
+            m_device.ack(response(*txn, 0));
+          } else {
+            const uint8_t pos = m_pos++;
+            txn->read_data[pos] = m_device.receive(response(*txn, m_pos));
+          }
+          break;
+
+        case i2c_master_idle:
+          if (m_phase == phase::reading) {
+            txn->read_data[m_pos++] = m_device.receive_raw();  // The last byte, we nacked it
+            finish(i2c_result::ok, true);
+          } else if (m_pos == txn->write_len) {
+            write_done(*txn);  // The slave may nack the last byte
+          } else {
+            finish(i2c_result::data_nack, true);
+          }
+          break;
+
+        case i2c_slave_addressed:  // FALLTHROUGH
+        case i2c_slave_transmit:
+          // We can't be addressed while we own the bus, so the arbitration was lost to a master
+          // that addresses us. Nothing restarts the transaction unless we do.
+          m_addressed = true;
+          return state;
+
+        case i2c_slave_stop:  // FALLTHROUGH
+        case i2c_idle:
+          if (m_addressed) {
+            m_addressed = false;
+            retry(*txn);  // The START is sent once the bus is free
+          }
+          return state;
+
+        default:
+          return state;
+      }
+      return i2c_busy;
+    }
+
+  private:
+    enum class phase : uint8_t { writing, read_address, reading };
+
+    void begin(i2c_transaction& txn) {
+      txn.result = i2c_result::pending;
+      m_txn = &txn;
+      m_retries = 0;
+      m_addressed = false;
+      restart(txn);
+    }
+
+    void retry(i2c_transaction& txn) {
+      if (m_retries < i2c_master_retries) {
+        m_retries++;
+        restart(txn);
+      } else {
+        finish(i2c_result::arbitration_lost, false);
+      }
+    }
+
+    void restart(i2c_transaction& txn) {
+      m_pos = 0;
+      if (txn.write_len || !txn.read_len) {
+        m_phase = phase::writing;
+        m_device.master_txn(txn.address, write);
+      } else {
+        m_phase = phase::read_address;
+        m_device.master_txn(txn.address, read);
+      }
+    }
+
+    void write_done(i2c_transaction& txn) {
+      if (txn.read_len) {
+        m_pos = 0;
+        m_phase = phase::read_address;
+        m_device.master_txn(txn.address, read);  // Repeated start
+      } else {
+        finish(i2c_result::ok, true);
+      }
+    }
+
+    // Ack the byte at `next` unless it is the last one.
+    static i2c_read_response response(const i2c_transaction& txn, uint8_t next) {
+      return next + 1 < txn.read_len ? i2c_ack_after_next : i2c_nack_after_next;
+    }
+
+    // `owned` is true if we still hold the bus, then the next transaction is started with a
+    // repeated start instead of a STOP followed by a START.
+    void finish(i2c_result result, bool owned) {
+      i2c_transaction& txn = *m_txn;
+      m_txn = nullptr;
+      if (!m_queue.empty()) {
+        begin(*m_queue.get());
+      } else if (owned) {
+        m_device.master_release();
+      }
+      txn.result = result;
+      if (txn.done) {
+        txn.done(txn);
+      }
+    }
+
+    Device& m_device;
+    i2c_transaction* volatile m_txn = nullptr;
+    spsc_queue<i2c_transaction*, max_pending> m_queue;
+    uint8_t m_pos = 0;
+    uint8_t m_retries = 0;
+    bool m_addressed = false;  // Addressed as a slave while the transaction waits for a restart
+    phase m_phase = phase::writing;
+  };
+}  // namespace xtd
+
+#endif
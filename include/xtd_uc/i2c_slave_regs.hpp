@@ -0,0 +1,131 @@
+#ifndef XTD_UC_I2C_SLAVE_REGS_HPP
+#define XTD_UC_I2C_SLAVE_REGS_HPP
+#include "common.hpp"
+
+#include "avr.hpp"
+#include "cstdint.hpp"
+#include "i2c.hpp"
+
+namespace xtd {
+  // Called when a write to an i2c_slave_regs has completed, with the first register written and
+  // the number of registers from it up to and including the last one written. Read-only registers
+  // are never counted as written, those in between are left unchanged.
+  using i2c_regs_callback = void (*)(uint8_t first, uint8_t count);
+
+  // Makes this device look like a typical I2C peripheral with a bank of N byte registers, all
+  // answered from the ISR without any user code per byte.
+  //
+  // A write sets the register pointer with its first byte, the following bytes are written to
+  // consecutive registers. A read returns consecutive registers starting at the register pointer.
+  // So a write of just the register pointer followed by a (repeated START) read reads registers
+  // from that address. Writes past the last register are acked and ignored, reads past it return
+  // 0xFF.
+  //
+  // Each register has a write mask in program memory, only the bits set in the mask can be
+  // changed by the master. A mask of 0 makes the register read-only. Without masks all bits are
+  // writable.
+  //
+  // Example:
+  //     xtd::i2c_device i2c;
+  //     const uint8_t masks[4] PROGMEM = {0x00, 0x00, 0xFF, 0x0F};  // Status, id, config, mode
+  //     xtd::i2c_slave_regs<4> regs(i2c, masks, on_config_written);
+  //
+  //     ISR(USI_START_vect) { regs.on_state(i2c.on_usi_start()); }
+  //     ISR(USI_OVF_vect) { regs.on_state(i2c.on_usi_ovf()); }
+  //
+  //     // The USI has no STOP interrupt, poll for it so that on_config_written isn't called late
+  //     // at the next START on the bus.
+  //     void poll_i2c_stop() {
+  //       ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { regs.on_state(i2c.poll_stop()); }
+  //     }
+  //
+  //     int main() {
+  //       ...
+  //       i2c.slave_on(0x15 << 1, false);
+  //       regs[0] = status;
+  //
+  // The registers are shared with the ISR, disable interrupts when a value spanning several
+  // registers must be read or updated consistently.
+  //
+  // The Device template parameter is for testing.
+  template <uint8_t N, typename Device = i2c_device>
+  class i2c_slave_regs {
+  public:
+    i2c_slave_regs(Device& device, const uint8_t* write_masks = nullptr,
+                   i2c_regs_callback on_write = nullptr)
+        : m_device(device), m_masks(write_masks), m_on_write(on_write) {}
+
+    volatile uint8_t& operator[](uint8_t reg) { return m_regs[reg]; }
+    const volatile uint8_t& operator[](uint8_t reg) const { return m_regs[reg]; }
+
+    // The register pointer, for the next read or write.
+    uint8_t pointer() const { return m_pointer; }
+
+    // Call from the ISRs with the return value of the on_.* method of the i2c_device. Slave
+    // states are handled and i2c_busy is returned, all other states are returned unchanged.
+    i2c_state on_state(i2c_state state) {
+      switch (state) {
+        case i2c_slave_addressed:
+          m_set_pointer = true;
+          m_count = 0;
+          break;
+
+        case i2c_slave_receive: {
+          const uint8_t data = m_device.receive(ack);
+          if (m_set_pointer) {
+            m_set_pointer = false;
+            m_pointer = data;
+          } else if (m_pointer < N) {
+            const uint8_t mask = m_masks ? pgm_read_byte(m_masks + m_pointer) : 0xFF;
+            if (mask) {
+              m_regs[m_pointer] = uint8_t((m_regs[m_pointer] & ~mask) | (data & mask));
+              if (m_count == 0) {
+                m_first = m_pointer;
+              }
+              m_count = uint8_t(m_pointer - m_first + 1);
+            }
+            m_pointer++;
+          }
+          break;
+        }
+
+        case i2c_slave_transmit:
+          if (m_pointer < N) {
+            m_device.transmit(m_regs[m_pointer++], false);
+          } else {
+            m_device.transmit(0xFF, false);
+          }
+          break;
+
+        case i2c_slave_stop:
+          if (m_count && m_on_write) {
+            m_on_write(m_first, m_count);
+          }
+          m_count = 0;
+          break;
+
+        default:
+          return state;
+      }
+      return i2c_busy;
+    }
+
+  private:
+#ifdef __AVR_MEGA__
+    constexpr static i2c_read_response ack = i2c_ack_after_next;
+#else
+    constexpr static i2c_read_response ack = i2c_ack;
+#endif
+
+    Device& m_device;
+    const uint8_t* const m_masks;
+    const i2c_regs_callback m_on_write;
+    volatile uint8_t m_regs[N] = {};
+    uint8_t m_pointer = 0;
+    uint8_t m_first = 0;
+    uint8_t m_count = 0;
+    bool m_set_pointer = false;
+  };
+}  // namespace xtd
+
+#endif
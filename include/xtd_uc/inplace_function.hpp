@@ -0,0 +1,61 @@
+#ifndef XTD_UC_INPLACE_FUNCTION_HPP
+#define XTD_UC_INPLACE_FUNCTION_HPP
+#include "common.hpp"
+
+#include "cstdint.hpp"
+#include "type_traits.hpp"
+#include "utility.hpp"
+
+namespace xtd {
+
+  template <typename Signature, fast_size_t bytes_ = 4>
+  class inplace_function;
+
+  // A polymorphic function wrapper, like std::function but without any dynamic memory allocation.
+  //
+  // The callable (typically a lambda) is copied into a fixed buffer of `bytes_` bytes inside the
+  // inplace_function, storing a callable that doesn't fit is a compile time error. The callable
+  // must be trivially copyable, which means that the inplace_function itself is trivially
+  // copyable and can be stored in an xtd::queue and handed over from an ISR by a plain copy.
+  //
+  // The size of an inplace_function is `bytes_` plus one function pointer.
+  //
+  // Example:
+  //     xtd::fcfs_scheduler<8, xtd::inplace_function<void(), 2>> scheduler;
+  //
+  //     ISR(USART_RX_vect) {
+  //       uint8_t data = UDR0;
+  //       uint8_t channel = 1;
+  //       scheduler.schedule([data, channel]() { process(channel, data); });
+  //     }
+  //
+  // Calling an empty inplace_function is undefined behaviour.
+  template <typename R, typename... Args, fast_size_t bytes_>
+  class inplace_function<R(Args...), bytes_> {
+  public:
+    inplace_function() = default;
+
+    template <typename F, typename = enable_if_t<!is_same<F, inplace_function>::value>>
+    inplace_function(F f) : m_invoke(&invoke<F>) {
+      static_assert(sizeof(F) <= bytes_, "Callable doesn't fit in the inplace_function storage!");
+      static_assert(alignof(F) <= alignof(void*), "Callable is over aligned!");
+      static_assert(is_trivially_copyable<F>::value, "Callable must be trivially copyable!");
+      __builtin_memcpy(m_storage, &f, sizeof(F));
+    }
+
+    R operator()(Args... args) const { return m_invoke(m_storage, forward<Args>(args)...); }
+
+    explicit operator bool() const { return m_invoke != nullptr; }
+
+  private:
+    template <typename F>
+    static R invoke(const void* storage, Args... args) {
+      return (*static_cast<const F*>(storage))(forward<Args>(args)...);
+    }
+
+    R (*m_invoke)(const void*, Args...) = nullptr;
+    alignas(void*) unsigned char m_storage[bytes_];  // Alignment only matters off target
+  };
+}  // namespace xtd
+
+#endif
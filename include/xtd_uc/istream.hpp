@@ -2,165 +2,302 @@
 #define XTD_UC_ISTREAM_HPP
 #include "common.hpp"
 
-#include "algorithm.hpp"
-
-#if 0  // Not done/working yet
+#include "cstdint.hpp"
+#include "limits.hpp"
+#include "type_traits.hpp"
 
 namespace xtd {
 
-  namespace ios_base {
+  // The stream state shared by all streams.
+  class ios_base {
+  public:
     using iostate = uint8_t;
 
     static constexpr iostate goodbit = 0;
     static constexpr iostate badbit = 1;
     static constexpr iostate failbit = 2;
     static constexpr iostate eofbit = 4;
-  }
-
-  template <typename Stream>
-  class istream;
-
-  template <>
-  class istream<usart> {
-  public:
-    using iostate = ios_base::iostate;
 
-    bool good() const { rdstate() == xtd::ios_base::goodbit; }
-    bool fail() const { rdstate() & (xtd::ios_base::failbit | xtd::ios_base::badbit); }
-    bool eof() const { rdstate() & xtd::ios_base::eofbit; }
-    bool bad() const { rdstate() & xtd::ios_base::badbit; }
+    bool good() const { return rdstate() == goodbit; }
+    bool fail() const { return (rdstate() & (failbit | badbit)) != 0; }
+    bool eof() const { return (rdstate() & eofbit) != 0; }
+    bool bad() const { return (rdstate() & badbit) != 0; }
 
     bool operator!() const { return fail(); }
     explicit operator bool() const { return !fail(); }
 
-    void clear(iostate state = xtd::ios_base::goodbit) { m_state = state; }
+    void clear(iostate state = goodbit) { m_state = state; }
 
     iostate rdstate() const { return m_state; }
-    void setstate(iostate state) { clear(rdstate() | state); }
+    void setstate(iostate state) { clear(iostate(rdstate() | state)); }
+
+  private:
+    iostate m_state = goodbit;
+  };
+
+  template <typename stream_tag>
+  class istream;
 
-    friend auto operator>>(istream<usart>& is, char& c) {}
+  // The unformatted input functions of istream, implemented on top of three functions provided by
+  // the istream<Tag> specialization that derives from this:
+  //
+  //   int_type underflow();  // Returns the next character without extracting it, waits for one
+  //                          // to arrive if necessary. Returns eof() if no more can arrive.
+  //   void bump();           // Extracts the character last returned by underflow().
+  //   size_type available(); // The number of characters that can be extracted without waiting.
+  //
+  // Example:
+  //     template <>
+  //     class istream<my_tag> : public istream_base<istream<my_tag>> {
+  //     public:
+  //       int_type underflow() { ... }
+  //       void bump() { ... }
+  //       size_type available() { ... }
+  //     };
+  template <typename Derived>
+  class istream_base : public ios_base {
+  public:
+    using int_type = int16_t;
+    using size_type = xtd::size_t;
+
+    constexpr static int_type eof() { return -1; }
 
-    template <typename T, typename xtd::enable_if_t<xtd::numeric_limits<T>::is_integer>>
-    friend auto operator>>(istream<usart>& is, T& integer) {
-      using unsigned_type = unsigned T;
-      using limits = xtd::numeric_limits<T>;
-      using unsigned_limits = xtd::numeric_limits<unsigned_type>;
+    // Extracts and returns one character, or eof() if none is available. Sets failbit and eofbit
+    // on failure.
+    int_type get() {
+      m_gcount = 0;
+      if (!sentry()) {
+        return eof();
+      }
+      const auto c = derived().underflow();
+      if (c == eof()) {
+        setstate(failbit | eofbit);
+      } else {
+        derived().bump();
+        m_gcount = 1;
+      }
+      return c;
+    }
 
-      is.skipws();
-      if (!is.good()) {
-        return;
+    Derived& get(char& c) {
+      const auto ch = get();
+      if (ch != eof()) {
+        c = char(ch);
       }
+      return derived();
+    }
 
-      static constexpr auto zero = unsigned_type();
-      static constexpr auto mulmask8 = ~((~zero) >> 3);  // Top three bits set.
+    // Returns the next character without extracting it, or eof() if none is available. Sets
+    // eofbit if no more characters are available.
+    int_type peek() {
+      m_gcount = 0;
+      if (!sentry()) {
+        return eof();
+      }
+      const auto c = derived().underflow();
+      if (c == eof()) {
+        setstate(eofbit);
+      }
+      return c;
+    }
 
-      auto absvalue = zero;
-      auto negative = (is.peek() == '-');
-      auto overflow = false;
-      if (negative) {
-        is.get();  // Remove it from the buffer.
-        if (!limits::is_signed) {
-          while (is.good() && !is.next_is_ws()) {
-            is.get();
-          }
-          is.setstate(xtd::ios_base::failbit);
-          integer = limits::min();
+    // Extracts exactly n characters into s. Sets failbit and eofbit if fewer were available.
+    Derived& read(char* s, size_type n) {
+      m_gcount = 0;
+      if (!sentry()) {
+        return derived();
+      }
+      while (m_gcount < n) {
+        const auto c = derived().underflow();
+        if (c == eof()) {
+          setstate(failbit | eofbit);
+          break;
         }
+        derived().bump();
+        s[m_gcount++] = char(c);
+      }
+      return derived();
+    }
+
+    // Extracts up to n characters that are already available into s, without waiting.
+    // Returns the number of characters extracted.
+    size_type readsome(char* s, size_type n) {
+      m_gcount = 0;
+      if (!sentry()) {
+        return 0;
+      }
+      auto avail = derived().available();
+      if (avail < n) {
+        n = avail;
+      }
+      while (m_gcount < n) {
+        s[m_gcount++] = char(derived().underflow());
+        derived().bump();
       }
+      return m_gcount;
+    }
 
-      while (!is.next_is_ws()) {
-        auto c = is.get();
-        if (is.good() && !overflow) {
-          if (!isdigit(c)) {
-            setstate(xtd::ios_base::failbit);
-            continue;
+    // Extracts characters into s until `delim` has been extracted (it is not stored), n - 1
+    // characters have been stored or there are no more characters. s is always null terminated.
+    // Sets failbit if no characters were extracted or if the line didn't fit in s.
+    Derived& getline(char* s, size_type n, char delim = '\n') {
+      m_gcount = 0;
+      size_type stored = 0;
+      if (sentry()) {
+        while (true) {
+          const auto c = derived().underflow();
+          if (c == eof()) {
+            setstate(m_gcount == 0 ? iostate(failbit | eofbit) : eofbit);
+            break;
           }
-
-          // newabsvalue = 10*absvalue + (c-'0') = absvalue*(8+2) + (c-'0')
-          //             = (absvalue << 3) + (absvalue << 1) + (c-'0')
-          auto by8 = absvalue << 3;
-          auto by2 = absvalue << 1;
-          auto digit = c - '0';
-
-          // Check that:
-          // 1) "absvalue*8" doesn't overflow.
-          // 2) "(absvalue*8) + (absvalue*2 + digit)" doesn't overflow
-          // Note: "absvalue*2 + digit" will never overflow as "absvalue*8" is representable and
-          // "absvalue*2 + 9 < absvalue*8" when "3/2 < absvalue" so the only absvalue for which
-          // "absvalue*2 + digit" could overflow when "absvalue*8" didn't overflow is when "absvalue
-          // <= 3/2" but we know that there exists no integer type for which "3/2" is above the
-          // maximum representable value.
-          if (absvalue & mulmask8 != 0 || by2 + digit > unsigned_limit::max() - by8) {
-            overflow = true;
-            continue;
+          if (char(c) == delim) {
+            derived().bump();
+            m_gcount++;
+            break;
           }
-          absvalue = by8 + by2 + digit;
+          if (stored + 1 >= n) {
+            setstate(failbit);
+            break;
+          }
+          derived().bump();
+          m_gcount++;
+          s[stored++] = char(c);
         }
       }
-
-      if (is.bad()) {
-        return is;
+      if (n > 0) {
+        s[stored] = '\0';
       }
+      return derived();
+    }
 
-      if (overflow) {
-        integer = negative ? limits::min() : limits::max();
-        setstate(xtd::ios_base::failbit);
-        return is;
+    // Extracts and discards up to n characters, stops after `delim` has been extracted.
+    Derived& ignore(size_type n = 1, int_type delim = eof()) {
+      m_gcount = 0;
+      if (!sentry()) {
+        return derived();
+      }
+      while (m_gcount < n) {
+        const auto c = derived().underflow();
+        if (c == eof()) {
+          setstate(eofbit);
+          break;
+        }
+        derived().bump();
+        m_gcount++;
+        if (c == delim) {
+          break;
+        }
       }
+      return derived();
+    }
 
-      if (limits::is_signed) {
-        if (negative) {
-          // Remember that "-limits::min()" is not representable in 2s complement.
-          auto max_abs = static_cast<unsigned_type>(-(limits::min() + 1)) + 1;
-          if (absvalue > max_abs) {
-            integer = limits::min();
-            setstate(xtd::ios_base::failbit);
-          } else {
-            integer = -absvalue;
-          }
+    // Extracts and discards leading white space.
+    Derived& ws() {
+      while (good()) {
+        const auto c = derived().underflow();
+        if (c == eof()) {
+          setstate(eofbit);
+        } else if (c == ' ' || (c >= '\t' && c <= '\r')) {
+          derived().bump();
         } else {
-          auto max_abs = static_cast<unsigned_type>(limits::max());
-          if (absvalue > max_abs) {
-            integer = limits::max();
-            setstate(xtd::ios_base::failbit);
-          } else {
-            integer = absvalue;
-          }
+          break;
         }
-      } else {  // if (limits::is_signed)
-        integer = absvalue;
       }
-      return is;
+      return derived();
     }
 
+    // The number of characters extracted by the last unformatted input function.
+    size_type gcount() const { return m_gcount; }
+
   private:
-    iostate m_state = xtd::ios_base::goodbit;
+    Derived& derived() { return static_cast<Derived&>(*this); }
 
-    bool next_is_ws() const {}
+    bool sentry() {
+      if (!good()) {
+        setstate(failbit);
+        return false;
+      }
+      return true;
+    }
 
-    void skipws() {}
+    size_type m_gcount = 0;
+  };
 
-    char get() {
-      // TODO: Add timeout
-      while (usart::is_enabled() && !usart::has_char() &&
-             rx_status_flag::good == usart::rx_status()) {
-        // wait until we get a char
-      }
+  template <typename stream_tag>
+  istream<stream_tag>& operator>>(istream<stream_tag>& is, char& c) {
+    if (is.ws().good()) {
+      is.get(c);
+    } else {
+      is.setstate(ios_base::failbit);
+    }
+    return is;
+  }
 
-      if (usart::has_char()) {
-        return usart::get();
-      }
-      if (!usart::is_enabled()) {
-        setstate(xtd::ios_base::eofbit);
-      }
-      if (rx_status_flag::good != usart::rx_status()) {
-        setstate(xtd::ios_base::badbit);
+  // Extracts a decimal integer with an optional sign, leading white space is skipped.
+  //
+  // Sets failbit if there are no digits. On overflow the value is clamped to the range of T and
+  // failbit is set. A negative number for an unsigned T yields 0 and sets failbit.
+  //
+  // The digits are accumulated towards the sign of the result so that the full range of signed
+  // types is accepted, and the overflow limits are compile time constants so no division is done
+  // at run time.
+  template <typename stream_tag, typename T>
+  xtd::enable_if_t<xtd::numeric_limits<T>::is_integer && !xtd::is_same<T, char>::value &&
+                       !xtd::is_same<T, bool>::value,
+                   istream<stream_tag>&>
+  operator>>(istream<stream_tag>& is, T& value) {
+    using limits = xtd::numeric_limits<T>;
+    constexpr T pos_cutoff = limits::max() / 10;
+    constexpr T pos_cutlim = limits::max() % 10;
+    constexpr T neg_cutoff = limits::min() / 10;
+    constexpr T neg_cutlim = T(-(limits::min() % 10));
+
+    if (!is.ws().good()) {
+      is.setstate(ios_base::failbit);
+      return is;
+    }
+
+    auto c = is.peek();
+    const bool negative = c == '-';
+    if (negative || c == '+') {
+      is.get();
+      c = is.peek();
+    }
+
+    T v = 0;
+    bool any = false;
+    bool overflow = false;
+    while (c >= '0' && c <= '9') {
+      is.get();
+      any = true;
+      const T d = T(c - '0');
+      if (!negative) {
+        if (v > pos_cutoff || (v == pos_cutoff && d > pos_cutlim)) {
+          overflow = true;
+        } else {
+          v = T(v * 10 + d);
+        }
+      } else if (limits::is_signed) {
+        if (v < neg_cutoff || (v == neg_cutoff && d > neg_cutlim)) {
+          overflow = true;
+        } else {
+          v = T(v * 10 - d);
+        }
       }
-      return 0;
+      c = is.peek();
     }
-  };
-}
 
-#endif
+    if (!any || (negative && !limits::is_signed)) {
+      value = 0;
+      is.setstate(ios_base::failbit);
+    } else if (overflow) {
+      value = negative ? limits::min() : limits::max();
+      is.setstate(ios_base::failbit);
+    } else {
+      value = v;
+    }
+    return is;
+  }
+}  // namespace xtd
 
 #endif
@@ -38,7 +38,9 @@ namespace xtd {
           static_cast<int>(numeric_limits_impl_int<T>::digits * 0.30102999566);
       constexpr static int max_digits10 = 0;
       constexpr static int radix = 2;
-      constexpr static T sign_mask = is_signed ? T(1) << digits : 0;
+      // Computed as -max - 1 as shifting a one into the sign bit overflows.
+      constexpr static T sign_mask =
+          is_signed ? T(-T(((T(1) << (digits - 1)) - 1) * 2 + 1) - 1) : T(0);
 
       constexpr static int min_exponent = 0;
       constexpr static int min_exponent10 = 0;
@@ -0,0 +1,256 @@
+#ifndef XTD_UC_LOG_HPP
+#define XTD_UC_LOG_HPP
+#include "common.hpp"
+
+#include "chrono.hpp"
+#include "cstdint.hpp"
+#include "format.hpp"
+#include "slip.hpp"
+#include "type_traits.hpp"
+
+#include <string.h>
+
+#ifdef ENABLE_TEST
+#include "fake_avr.hpp"
+#else
+#include <util/atomic.h>
+#endif
+
+// Tokenized binary logging.
+//
+// Instead of formatting text on the MCU, each XTD_LOG() statement is given a 16 bit ID at compile
+// time and only the ID, a timestamp and the raw bytes of the arguments are stored in a
+// log_buffer. The buffer is drained as SLIP frames (see "slip.hpp") and the host tool in
+// tools/log_decode.cpp turns them back into text.
+//
+// The format strings never reach the MCU. They are placed in the ".xtd_log" section of the ELF
+// file, which isn't loaded as it isn't part of the usual `avr-objcopy -j .text -j .data` when
+// creating the HEX file. Extract the table for the decoder with:
+//
+//     avr-objcopy -O binary --only-section=.xtd_log firmware.elf firmware.log
+//     xtd_log_decode firmware.log < /dev/ttyUSB0
+//
+// The format strings have the same syntax as xtd::format(), see "format.hpp", and are checked
+// against the arguments at compile time. Arguments may be bool, char, integers and floats;
+// strings aren't supported, put them in the format instead.
+//
+// The ID is a hash of the base name of the file and the line number, which keeps it stable
+// between builds in different directories. Consequently there can be at most one XTD_LOG() per
+// line. The decoder warns about IDs that collide.
+//
+// Example:
+//     xtd::log_buffer<256> logger;
+//
+//     ISR(ADC_vect) {
+//       XTD_LOG(logger, "adc: {} at {:x}", ADC, ADMUX);
+//     }
+//
+//     void log_task() {  // Run periodically, or when the UART is idle
+//       logger.drain<xtd::uart_put>();
+//     }
+#define XTD_LOG(logger, ...)                                                                    \
+  do {                                                                                          \
+    __attribute__((section(".xtd_log"), used)) static const char xtd_log_entry[] =              \
+        "\x01" __FILE__ "\0" XTD_LOG_STR_(__LINE__) "\0" XTD_LOG_FIRST_(__VA_ARGS__, 0);         \
+    using xtd_log_kinds = decltype(xtd::detail::log_kinds(__VA_ARGS__));                        \
+    static_assert(xtd::detail::format_validate(XTD_LOG_FIRST_(__VA_ARGS__, 0),                  \
+                                               xtd_log_kinds::value, xtd_log_kinds::count) ==    \
+                      xtd::detail::format_error::ok,                                            \
+                  "The log format doesn't match the arguments!");                               \
+    constexpr uint16_t xtd_log_id = xtd::detail::log_id(__FILE__, __LINE__);                    \
+    (logger).write(xtd_log_id, __VA_ARGS__);                                                    \
+  } while (0)
+
+#define XTD_LOG_STR2_(x) #x
+#define XTD_LOG_STR_(x) XTD_LOG_STR2_(x)
+#define XTD_LOG_FIRST_(first, ...) first
+
+namespace xtd {
+  namespace detail {
+    // FNV-1a of the base name of `path` followed by the line number, folded to 16 bits.
+    // 0 is reserved for the dropped records frame.
+    constexpr uint16_t log_id(const char* path, uint16_t line) {
+      const char* name = path;
+      for (const char* p = path; *p; ++p) {
+        if (*p == '/' || *p == '\\') {
+          name = p + 1;
+        }
+      }
+      uint32_t h = 2166136261UL;
+      for (; *name; ++name) {
+        h = (h ^ uint8_t(*name)) * 16777619UL;
+      }
+      h = (h ^ uint8_t(line)) * 16777619UL;
+      h = (h ^ uint8_t(line >> 8)) * 16777619UL;
+      const uint16_t id = uint16_t((h >> 16) ^ h);
+      return id ? id : 1;
+    }
+
+    // The kinds of the arguments of XTD_LOG(), strings are rejected as only their address would
+    // be logged.
+    template <typename T>
+    constexpr format_kind log_kind() {
+      return (format_kind_of<T>::value == format_kind::string ||
+              format_kind_of<T>::value == format_kind::pstring)
+                 ? format_kind::none
+                 : format_kind_of<T>::value;
+    }
+
+    template <typename... Args>
+    struct log_kinds_t {
+      constexpr static uint8_t count = sizeof...(Args);
+      constexpr static format_kind value[] = {log_kind<Args>()..., format_kind::none};
+    };
+
+    template <typename... Args>
+    constexpr format_kind log_kinds_t<Args...>::value[];
+
+    // Only used in unevaluated context.
+    template <size_t n, typename... Args>
+    log_kinds_t<Args...> log_kinds(const char (&)[n], const Args&...);
+
+    template <typename T>
+    constexpr uint8_t log_arg_size() {
+      return format_kind_of<T>::value == format_kind::floating ? 4 : uint8_t(sizeof(T));
+    }
+
+    constexpr uint8_t log_args_size() { return 0; }
+
+    template <typename T, typename... Rest>
+    constexpr uint8_t log_args_size(const T*, const Rest*... rest) {
+      return uint8_t(1 + log_arg_size<T>() + log_args_size(rest...));
+    }
+
+    inline uint8_t* log_put_bytes(uint8_t* out, uint64_t v, uint8_t n) {
+      for (uint8_t i = 0; i < n; ++i) {
+        *out++ = uint8_t(v);
+        v >>= 8;
+      }
+      return out;
+    }
+
+    inline uint8_t* log_put_args(uint8_t* out) { return out; }
+
+    // Each argument is a tag byte, the format_kind in the low nibble and the number of bytes in
+    // the high nibble, followed by its bytes in little endian order.
+    template <typename T, typename... Rest>
+    uint8_t* log_put_args(uint8_t* out, const T& v, const Rest&... rest) {
+      constexpr auto kind = format_kind_of<T>::value;
+      constexpr uint8_t size = log_arg_size<T>();
+      *out++ = uint8_t(uint8_t(kind) | (size << 4));
+      if (kind == format_kind::floating) {
+        const float f = float(v);
+        uint32_t bits;
+        memcpy(&bits, &f, sizeof(bits));
+        out = log_put_bytes(out, bits, size);
+      } else {
+        out = log_put_bytes(out, uint64_t(v), size);
+      }
+      return log_put_args(out, rest...);
+    }
+  }  // namespace detail
+
+  // A ring buffer of binary log records, see XTD_LOG().
+  //
+  // A record is the ID, the low 32 bits of Clock::now() in ticks and the arguments. When the
+  // buffer is full new records are dropped, whole, and counted. The count is sent to the host as
+  // a frame with ID 0 by the next drain.
+  //
+  // Records may be written from any context including ISRs, interrupts are disabled while the
+  // record is copied into the buffer. drain() must only be called from one context.
+  //
+  // `len` is the size of the buffer in bytes, a power of two.
+  template <uint16_t len, typename Clock = chrono::steady_clock>
+  class log_buffer {
+  public:
+    static_assert(len >= 16 && (len & (len - 1)) == 0, "len must be a power of two >= 16!");
+
+    // Called by XTD_LOG(), the format is only used for the compile time check.
+    template <size_t n, typename... Args>
+    void write(uint16_t id, const char (&)[n], const Args&... args) {
+      constexpr uint8_t size =
+          uint8_t(header_size + detail::log_args_size(static_cast<const Args*>(nullptr)...));
+      static_assert(size < len, "The record doesn't fit in the buffer!");
+
+      uint8_t record[size];
+      record[0] = size;
+      auto out = detail::log_put_bytes(record + 1, id, 2);
+      out = detail::log_put_bytes(out, uint32_t(Clock::now().time_since_epoch().count()), 4);
+      detail::log_put_args(out, args...);
+
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (uint16_t(len - uint16_t(m_write - m_read)) < size) {
+          if (m_dropped != 0xFFFF) {
+            m_dropped++;
+          }
+        } else {
+          for (uint8_t i = 0; i < size; ++i) {
+            m_buffer[m_write++ & mask] = record[i];
+          }
+        }
+      }
+    }
+
+    // Sends one frame through `sink`, for example uart_put(). Returns false if there was
+    // nothing to send.
+    template <void (*sink)(char)>
+    bool drain_one() {
+      uint16_t write;
+      uint16_t dropped;
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        write = m_write;
+        dropped = m_dropped;
+        m_dropped = 0;
+      }
+
+      slip_encoder<sink> encoder;
+      if (dropped) {
+        encoder.begin();
+        encoder.put(0);
+        encoder.put(0);
+        encoder.put(uint8_t(dropped));
+        encoder.put(uint8_t(dropped >> 8));
+        encoder.end();
+        return true;
+      }
+      if (write == m_read) {
+        return false;
+      }
+
+      uint16_t read = m_read;
+      const uint8_t size = m_buffer[read++ & mask];
+      encoder.begin();
+      for (uint8_t i = 1; i < size; ++i) {
+        encoder.put(m_buffer[read++ & mask]);
+      }
+      encoder.end();
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { m_read = read; }
+      return true;
+    }
+
+    // Sends frames until the buffer is empty.
+    template <void (*sink)(char)>
+    void drain() {
+      while (drain_one<sink>()) {
+      }
+    }
+
+    // The number of bytes used by records that haven't been drained.
+    uint16_t size() const {
+      uint16_t ans;
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { ans = uint16_t(m_write - m_read); }
+      return ans;
+    }
+
+  private:
+    constexpr static uint8_t header_size = 1 + 2 + 4;  // Length, ID and timestamp
+    constexpr static uint16_t mask = len - 1;
+
+    uint8_t m_buffer[len];
+    volatile uint16_t m_write = 0;
+    volatile uint16_t m_read = 0;
+    volatile uint16_t m_dropped = 0;
+  };
+}  // namespace xtd
+
+#endif
@@ -6,6 +6,8 @@
 #include "limits.hpp"
 #include "type_traits.hpp"
 
+#include <string.h>
+
 namespace xtd {
 
   template <typename stream_tag>
@@ -33,37 +35,216 @@ namespace xtd {
     return os;
   }
 
+  namespace detail {
+    // The powers of ten from the largest that fits in U down to 10, computed at compile time.
+    template <typename U>
+    struct pow10_table {
+      constexpr static uint8_t size = uint8_t(numeric_limits<U>::digits10);
+      U value[size];
+
+      constexpr pow10_table() : value() {
+        U p = 1;
+        for (uint8_t i = size; i-- > 0;) {
+          p = U(p * 10);
+          value[i] = p;
+        }
+      }
+    };
+
+    template <typename U>
+    struct pow10_lut {
+      static const pow10_table<U> table;
+    };
+
+    template <typename U>
+    const pow10_table<U> pow10_lut<U>::table PROGMEM = pow10_table<U>();
+
+    template <typename U>
+    U pgm_read(const U* addr) {
+      U ans = 0;
+      for (uint8_t i = 0; i < sizeof(U); ++i) {
+        ans = U(ans | U(U(pgm_read_byte(reinterpret_cast<const uint8_t*>(addr) + i)) << (8 * i)));
+      }
+      return ans;
+    }
+
+    // Writes the decimal digits of v to out, which must have room for digits10 + 1 characters,
+    // and returns the number of digits. AVR has no hardware divider so instead of dividing by
+    // ten, each digit is found by subtracting its power of ten at most nine times.
+    //
+    // Only instantiated for the four unsigned widths, all integer types are funneled into these.
+    template <typename U>
+    uint8_t format_decimal(U v, char* out) {
+      const auto& table = pow10_lut<U>::table;
+      char* o = out;
+      for (uint8_t i = 0; i < table.size; ++i) {
+        const U p = pgm_read(&table.value[i]);
+        char digit = '0';
+        while (v >= p) {
+          v = U(v - p);
+          ++digit;
+        }
+        if (digit != '0' || o != out) {
+          *o++ = digit;
+        }
+      }
+      *o++ = char('0' + v);
+      return uint8_t(o - out);
+    }
+
+    template <typename T>
+    using format_unsigned_t = conditional_t<
+        sizeof(T) == 1, uint8_t,
+        conditional_t<sizeof(T) == 2, uint16_t, conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>>;
+
+    // Prints v in decimal, padded with leading zeros to at least `width` digits.
+    template <typename stream_tag, typename U>
+    void put_decimal(ostream<stream_tag>& os, U v, uint8_t width = 0) {
+      char buf[numeric_limits<U>::digits10 + 1];
+      const auto n = format_decimal(v, buf);
+      for (uint8_t i = n; i < width; ++i) {
+        os.put('0');
+      }
+      for (uint8_t i = 0; i < n; ++i) {
+        os.put(buf[i]);
+      }
+    }
+
+    // Header only storage of the floating point precision, one per stream tag.
+    template <typename stream_tag>
+    struct ostream_state {
+      static uint8_t precision;
+    };
+
+    template <typename stream_tag>
+    uint8_t ostream_state<stream_tag>::precision = 6;
+
+    struct setprecision_t {
+      uint8_t n;
+    };
+  }  // namespace detail
+
+  // The largest number of digits after the decimal point that floats can be printed with.
+  constexpr uint8_t max_precision = 9;
+
+  // Sets the number of digits printed after the decimal point by subsequent floating point
+  // output, like "%.nf". The default is 6. Values above max_precision are clamped.
+  //
+  // Unlike std::setprecision the precision is shared by all streams with the same tag, the
+  // user defined ostream specializations need not have any state for it.
+  //
+  // Example:
+  //     uart << xtd::setprecision(2) << 3.14159f;  // Prints 3.14
+  inline detail::setprecision_t setprecision(uint8_t n) {
+    return detail::setprecision_t{n < max_precision ? n : max_precision};
+  }
+
+  template <typename stream_tag>
+  auto& operator<<(ostream<stream_tag>& os, detail::setprecision_t p) {
+    detail::ostream_state<stream_tag>::precision = p.n;
+    return os;
+  }
+
+  // Prints a float in fixed point notation with the set precision, see setprecision().
+  //
+  // The digits are produced from the binary representation with integer arithmetic only, the
+  // value is m * 2^-shift where m is the 24 bit mantissa. The integer part is m >> shift and
+  // the fraction is rounded from (m mod 2^shift) * 10^precision >> shift, which fits in 64 bits.
+  // This avoids linking the avr-libc floating point printf (-lprintf_flt) and its stack buffer.
+  //
+  // Values of 2^64 and above, where the integer part no longer fits, are printed in scientific
+  // notation instead, e.g. "3.00e20".
   template <typename stream_tag>
   auto& operator<<(ostream<stream_tag>& os, float data) {
-    char buf[32];
-    snprintf_P(buf, 32, PSTR("%f"), data);
-    os << buf;
+    static_assert(sizeof(float) == sizeof(uint32_t), "IEEE 754 single precision float assumed!");
+    uint32_t bits;
+    memcpy(&bits, &data, sizeof(bits));
+    if (bits & 0x80000000UL) {
+      os.put('-');
+    }
+    uint8_t exponent = uint8_t(bits >> 23);
+    uint32_t mantissa = bits & 0x007FFFFFUL;
+    if (exponent == 0xFF) {
+      return os << (mantissa ? pstr(PSTR("nan")) : pstr(PSTR("inf")));
+    }
+    if (exponent) {
+      mantissa |= 0x00800000UL;
+    } else {
+      exponent = 1;  // Denormal
+    }
+
+    const uint8_t precision = detail::ostream_state<stream_tag>::precision;
+    const uint32_t scale =
+        precision ? detail::pgm_read(&detail::pow10_lut<uint32_t>::table.value[9 - precision])
+                  : 1;
+
+    // 2^64 is where the integer part overflows, normalize by powers of ten with float
+    // arithmetic. This is rarely used so size matters more than speed here. The mantissa is
+    // kept below 10 after rounding to the precision, so 9.999 doesn't print as 10.00.
+    if (exponent >= 127 + 64) {
+      float magnitude = data < 0 ? -data : data;
+      const float half_digit = 0.5f / float(scale);
+      uint8_t exponent10 = 0;
+      while (magnitude + half_digit >= 10) {
+        magnitude /= 10;
+        exponent10++;
+      }
+      os << magnitude;
+      os.put('e');
+      detail::put_decimal(os, exponent10);
+      return os;
+    }
+
+    // Rounds half to even, like printf.
+    const int16_t shift = int16_t(127 + 23 - exponent);
+    uint64_t integer;
+    uint32_t fraction = 0;
+    if (shift <= 0) {
+      integer = uint64_t(mantissa) << -shift;
+    } else {
+      integer = shift < 24 ? mantissa >> shift : 0;
+      if (shift <= 55) {
+        const uint64_t remainder = shift < 24 ? mantissa & ((uint32_t(1) << shift) - 1) : mantissa;
+        const uint64_t scaled = remainder * scale;
+        const uint64_t half = uint64_t(1) << (shift - 1);
+        const uint64_t rest = scaled & ((half << 1) - 1);
+        fraction = uint32_t(scaled >> shift);
+        const bool odd = precision ? (fraction & 1) : (integer & 1);
+        if (rest > half || (rest == half && odd)) {
+          fraction++;
+        }
+        if (fraction >= scale) {
+          integer++;
+          fraction -= scale;
+        }
+      }
+    }
+
+    if (integer >> 32) {
+      detail::put_decimal(os, integer);
+    } else {
+      detail::put_decimal(os, uint32_t(integer));
+    }
+    if (precision) {
+      os.put('.');
+      detail::put_decimal(os, fraction, precision);
+    }
     return os;
   }
 
+  // Prints an integer in decimal. Signed values are printed as a '-' and their magnitude, which
+  // is computed in the unsigned type so that the minimum value doesn't overflow.
   template <typename stream_tag, typename T>
-  xtd::enable_if_t<xtd::numeric_limits<T>::is_integer, ostream<stream_tag>&> operator<<(
-      ostream<stream_tag>& os, T data) {
+  xtd::enable_if_t<xtd::numeric_limits<T>::is_integer && !xtd::is_same<T, bool>::value,
+                   ostream<stream_tag>&>
+  operator<<(ostream<stream_tag>& os, T data) {
+    using U = detail::format_unsigned_t<T>;
+    U magnitude = U(data);
     if (data < 0) {
       os.put('-');
-      data = -data;
-    } else if (data == 0) {
-      os.put('0');
-    }
-    char out_rev[21];
-    char* out = out_rev;
-    constexpr T base = 10;
-    while (data) {
-      auto quotient = data / base;
-      auto remainder = data % base;
-      *out = static_cast<char>('0' + remainder);
-      ++out;
-      data = quotient;
-    }
-    while (out != out_rev) {
-      --out;
-      os.put(*out);
+      magnitude = U(~magnitude + 1);
     }
+    detail::put_decimal(os, magnitude);
     return os;
   }
 }  // namespace xtd
@@ -0,0 +1,149 @@
+#ifndef XTD_UC_POWER_HPP
+#define XTD_UC_POWER_HPP
+#include "common.hpp"
+
+#include "chrono.hpp"
+#include "cstdint.hpp"
+
+#ifdef ENABLE_TEST
+#include "fake_avr.hpp"
+#else
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <util/atomic.h>
+#endif
+
+// The number of CPU cycles the MCU needs to start its clock source when waking up from
+// Power-save or Power-down. The default is the datasheet value for a crystal oscillator
+// (16K CK), adjust it to match your fuse settings.
+#ifndef POWER_WAKEUP_CYCLES
+#define POWER_WAKEUP_CYCLES 16384UL
+#endif
+
+namespace xtd {
+  // The sleep modes, ordered from the shallowest to the deepest.
+  //
+  // TIMER2 runs from the I/O clock unless it is clocked asynchronously (ASSR.AS2) from a crystal,
+  // only then does it keep running in ADC Noise Reduction and Power-save.
+  //
+  // The power manager never picks ADC Noise Reduction: entering it starts a conversion, so an
+  // enabled ADC would complete a spurious conversion on every sleep. It is only used by
+  // adc_read_single_low_noise() which owns the conversion.
+  enum class sleep_mode : uint8_t {
+    idle,        // Only the CPU and flash clocks are halted
+    adc,         // ADC Noise Reduction, the I/O clock is halted, starts a conversion if enabled
+    power_save,  // Only asynchronous TIMER2, TWI address match, external irqs and watchdog remain
+    power_down   // Only TWI address match, external interrupts and the watchdog remain
+  };
+
+  // The peripherals that may prevent the MCU from entering a deeper sleep mode while active.
+  // Each peripheral is one bit in the power managers active mask.
+  //
+  // `app` is active from reset, so the schedulers sleep in Idle like they did before the power
+  // manager existed. Interrupts the power manager doesn't know about, such as TIMER0/TIMER1
+  // compare matches, SPI or the analog comparator, can't wake the MCU from the deeper modes. Clear
+  // `app` to opt in to them once every interrupt source that posts tasks either wakes the MCU from
+  // Power-down or keeps `app` set while it needs the I/O clock.
+  enum class power_user : uint8_t {
+    uart = 1 << 0,    // Needs the I/O clock
+    i2c = 1 << 1,     // Needs the I/O clock
+    adc = 1 << 2,     // Needs the I/O clock for auto triggers and to avoid spurious conversions
+    chrono = 1 << 3,  // Needs TIMER2, Idle unless TIMER2 is asynchronous then at most Power-save
+    app = 1 << 4,     // For application use, needs the I/O clock, active from reset
+    uart1 = 1 << 5    // The second USART, needs the I/O clock
+  };
+
+  namespace detail {
+    // Header only storage of the active mask.
+    template <typename = void>
+    struct power_state {
+      static volatile uint8_t active;
+    };
+
+    constexpr uint8_t power_reset_active = uint8_t(power_user::app);
+
+    template <typename T>
+    volatile uint8_t power_state<T>::active = power_reset_active;
+
+    constexpr uint8_t power_idle_users = uint8_t(power_user::uart) | uint8_t(power_user::i2c) |
+                                         uint8_t(power_user::adc) | uint8_t(power_user::app) |
+                                         uint8_t(power_user::uart1);
+    constexpr uint8_t power_save_users = uint8_t(power_user::chrono);
+
+    // Writes to these TIMER2 registers haven't reached the asynchronous clock domain yet, a
+    // compare match may be lost if the MCU enters Power-save now.
+    constexpr uint8_t power_timer2_busy =
+        _BV(TCN2UB) | _BV(OCR2AUB) | _BV(OCR2BUB) | _BV(TCR2AUB) | _BV(TCR2BUB);
+  }  // namespace detail
+
+  // Registers a peripheral as active or inactive with the power manager. Drivers in this library
+  // do this themselves when they are enabled and disabled, call it for `power_user::app` if your
+  // own code needs the I/O clock while the scheduler sleeps.
+  // May be called safely from ISRs.
+  inline void power_set_active(power_user u, bool active) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+      if (active) {
+        detail::power_state<>::active |= uint8_t(u);
+      } else {
+        detail::power_state<>::active &= uint8_t(~uint8_t(u));
+      }
+    }
+  }
+
+  // Returns the deepest sleep mode that is compatible with every active peripheral.
+  inline sleep_mode power_deepest_sleep_mode() {
+    const uint8_t active = detail::power_state<>::active;
+    if (active & detail::power_idle_users) {
+      return sleep_mode::idle;
+    }
+    if (active & detail::power_save_users) {
+      const uint8_t assr = ASSR;
+      if (!(assr & _BV(AS2)) || (assr & detail::power_timer2_busy)) {
+        return sleep_mode::idle;  // TIMER2 runs from the I/O clock or is being updated
+      }
+      return sleep_mode::power_save;
+    }
+    return sleep_mode::power_down;
+  }
+
+  // As above but also considers the time until the next deadline. If the clock source of the
+  // MCU cannot restart before the deadline, the MCU stays in Idle where the clock keeps running.
+  inline sleep_mode power_deepest_sleep_mode(const chrono::steady_clock::duration& until_deadline) {
+    constexpr auto wakeup_ticks =
+        chrono::steady_clock::value_type((POWER_WAKEUP_CYCLES + 1023) / 1024);
+    const auto mode = power_deepest_sleep_mode();
+    if (mode >= sleep_mode::power_save && until_deadline.count() <= wakeup_ticks) {
+      return sleep_mode::idle;
+    }
+    return mode;
+  }
+
+  // Puts the MCU to sleep in the given mode until the next interrupt.
+  //
+  // CAUTION: Must be called with global interrupts disabled, they are enabled while sleeping and
+  // disabled again on return. This avoids a race where an ISR schedules work between checking
+  // for work and going to sleep.
+  inline void power_sleep(sleep_mode mode) {
+    switch (mode) {
+      case sleep_mode::idle:
+        set_sleep_mode(SLEEP_MODE_IDLE);
+        break;
+      case sleep_mode::adc:
+        set_sleep_mode(SLEEP_MODE_ADC);
+        break;
+      case sleep_mode::power_save:
+        set_sleep_mode(SLEEP_MODE_PWR_SAVE);
+        break;
+      case sleep_mode::power_down:
+        set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+        break;
+    }
+    sleep_enable();
+    sei();  // Interrups enabled while sleeping, takes effect after the next instruction
+    sleep_cpu();
+    cli();
+    sleep_disable();
+  }
+}  // namespace xtd
+
+#endif
@@ -2,9 +2,79 @@
 #define XTD_UC_QUEUE_HPP
 #include "common.hpp"
 
+#include "algorithm.hpp"
 #include "cstdint.hpp"
+#include "span.hpp"
 
 namespace xtd {
+  namespace detail {
+    // Index book keeping for a circular buffer of N elements.
+    //
+    // For N = 2^k the read and write indices are free running and wrapped with a mask, the size is
+    // simply their difference.
+    template <fast_size_t N, bool power_of_two = (N & (N - 1)) == 0>
+    class queue_indices {
+    public:
+      using size_type = fast_size_t;
+
+      static_assert(N <= 128, "N must fit the free running index range!");
+
+      size_type size() const { return size_type(m_write - m_read); }
+      bool empty() const { return m_read == m_write; }
+
+      size_type front() const { return m_read & mask; }
+      size_type back() const { return m_write & mask; }
+
+      void push(size_type n = 1) { m_write = size_type(m_write + n); }
+      void pop(size_type n = 1) { m_read = size_type(m_read + n); }
+
+      void clear() {
+        m_read = 0;
+        m_write = 0;
+      }
+
+    private:
+      constexpr static size_type mask = N - 1;
+
+      size_type m_read = 0;
+      size_type m_write = 0;
+    };
+
+    // For other N the read index and the element count are stored. The read index is wrapped with
+    // a compare instead of a modulo, which would be a division on AVR.
+    template <fast_size_t N>
+    class queue_indices<N, false> {
+    public:
+      using size_type = fast_size_t;
+
+      size_type size() const { return m_count; }
+      bool empty() const { return m_count == 0; }
+
+      size_type front() const { return m_read; }
+      size_type back() const {
+        // Cannot overflow as m_read < N and m_count <= N and N <= 255.
+        const auto i = m_read + m_count;
+        return size_type(i >= N ? i - N : i);
+      }
+
+      void push(size_type n = 1) { m_count = size_type(m_count + n); }
+      void pop(size_type n = 1) {
+        // Cannot overflow as m_read < N and n <= m_count <= N and N <= 255.
+        const auto i = m_read + n;
+        m_read = size_type(i >= N ? i - N : i);
+        m_count = size_type(m_count - n);
+      }
+
+      void clear() {
+        m_read = 0;
+        m_count = 0;
+      }
+
+    private:
+      size_type m_read = 0;
+      size_type m_count = 0;
+    };
+  }  // namespace detail
 
   // A bounded queue implemented using a circular buffer.
   //
@@ -13,49 +83,43 @@ namespace xtd {
   // * trivially destructible
   // * copy assignible
   //
-  // Upon instantiation, a buffer of N+1 elements is default constructed.
+  // Upon instantiation, a buffer of exactly N elements is default constructed.
   //
-  // For best performance, make sure N = 2^k - 1 for some k. This makes sure
-  // that the code is free from divisions and multiplications.
+  // All operations are O(1) and free from divisions and multiplications. For best performance make
+  // sure N = 2^k for some k, this allows the indices to be wrapped with a mask instead of a
+  // compare and branch.
+  //
+  // This code assumes single threaded MCU, see spsc_queue for handing data between an ISR and the
+  // main program.
   template <typename T, fast_size_t N>
   class queue {
   public:
     using size_type = fast_size_t;
 
+    static_assert(N > 0, "A queue must have room for at least one element!");
+
     size_type capacity() const { return N; }
 
-    size_type size() const {
-      if (empty()) {
-        return size_type();
-      } else if (write > read) {
-        return size_type(write - read);  // Cannot overflow
-      } else {
-        return size_type(N - read + write + 1);  // Cannot overflow (N > read > write)
-      }
-    }
+    size_type size() const { return indices.size(); }
 
     // Empties the queue (objects in the queue are not destructed)
-    void clear() {
-      read = 0;
-      write = 0;
-    }
+    void clear() { indices.clear(); }
 
     // Pushes a new value onto the queue.
     // If the queue is full() then pushing a new value is undefined behaviour.
     void push(const T& v) {
-      buffer[write] = v;
-      write = inc(write);
+      buffer[indices.back()] = v;
+      indices.push();
     }
 
     // Removes the front element from the queue.
-    void pop() { read = inc(read); }
+    void pop() { indices.pop(); }
 
     // Returns true if the queue is full and unable to accept another element.
     bool full() const { return size() == capacity(); }
 
-    // Returns true if the queue is empty. Prefer this to using size() == 0 as this is slightly
-    // faster.
-    bool empty() const { return read == write; }
+    // Returns true if the queue is empty.
+    bool empty() const { return indices.empty(); }
 
     // Steal the next element from the queue (the element is removed from the queue).
     // If the queue is empty() then this causes undefined behaviour.
@@ -67,14 +131,64 @@ namespace xtd {
 
     // Look at the next element of the queue without removing it.
     // IF the queue is empty() then this causes undefined behaviour.
-    T& peek() { return buffer[read]; }
+    T& peek() { return buffer[indices.front()]; }
 
-  private:
-    T buffer[N + 1];
-    size_type read = 0;
-    size_type write = 0;
+    // Pushes up to n elements from src onto the queue.
+    // Returns the number of elements pushed, which is less than n if the queue became full.
+    size_type push_n(const T* src, size_type n) {
+      auto region = writable();
+      n = min<size_type>(n, size_type(region.size()));
+      const auto first = min<size_type>(n, size_type(region.first.size()));
+      copy_n(src, first, region.first.data());
+      copy_n(src + first, size_type(n - first), region.second.data());
+      commit(n);
+      return n;
+    }
+
+    // Pops up to n elements from the queue into dst.
+    // Returns the number of elements popped, which is less than n if the queue became empty.
+    size_type pop_n(T* dst, size_type n) {
+      auto region = readable();
+      n = min<size_type>(n, size_type(region.size()));
+      const auto first = min<size_type>(n, size_type(region.first.size()));
+      copy_n(region.first.data(), first, dst);
+      copy_n(region.second.data(), size_type(n - first), dst + first);
+      consume(n);
+      return n;
+    }
+
+    // Returns the elements in the queue, front first, as two contiguous spans.
+    //
+    // This allows a consumer to hand the data directly to a peripheral or memcpy it out of the
+    // buffer. Call consume() to remove the elements once done with them.
+    ring_span<T> readable() {
+      const auto n = size();
+      const auto front = indices.front();
+      const auto first = min<size_type>(n, size_type(N - front));
+      return {span<T>(buffer + front, first), span<T>(buffer, size_type(n - first))};
+    }
+
+    // Returns the free slots at the back of the queue, in queue order, as two contiguous spans.
+    //
+    // This allows a producer to write, or memcpy, data directly into the buffer. Call commit() to
+    // push the written elements onto the queue.
+    ring_span<T> writable() {
+      const auto n = size_type(N - size());
+      const auto back = indices.back();
+      const auto first = min<size_type>(n, size_type(N - back));
+      return {span<T>(buffer + back, first), span<T>(buffer, size_type(n - first))};
+    }
+
+    // Removes the n front elements from the queue. n must not be larger than size().
+    void consume(size_type n) { indices.pop(n); }
 
-    size_type inc(size_type i) { return size_type((i + 1) % (N + 1)); }
+    // Pushes the n first elements of writable() onto the queue. n must not be larger than
+    // capacity() - size().
+    void commit(size_type n) { indices.push(n); }
+
+  private:
+    T buffer[N];
+    detail::queue_indices<N> indices;
   };
 }  // namespace xtd
 
@@ -3,10 +3,11 @@
 #include "common.hpp"
 
 #include "cstdint.hpp"
+#include "power.hpp"
 #include "queue.hpp"
+#include "sched_stats.hpp"
 
 #include <avr/interrupt.h>
-#include <avr/sleep.h>
 #include <util/atomic.h>
 
 namespace xtd {
@@ -21,9 +22,24 @@ namespace xtd {
   // __attribute__((used)) to prevent the linker removing it if there
   // are no direct calls to it outside of the scheduler.
   //
-  // If the system is overloaded, new tasks will not be admitted.
+  // By default tasks are plain function pointers. Any copyable callable type
+  // can be used instead by passing it as `task_type_`, in particular an
+  // xtd::inplace_function lets an ISR post a task together with its context
+  // (e.g. "process byte X from channel Y") as one bounded size record instead
+  // of going through global mailbox variables:
   //
-  // It does not support scheduling tasks in the future. For this reason
+  //     xtd::fcfs_scheduler<8, xtd::inplace_function<void(), 2>> scheduler;
+  //     scheduler.schedule([data, channel]() { process(channel, data); });
+  //
+  // When there are no tasks the MCU sleeps in the deepest sleep mode allowed by the active
+  // peripherals, see "power.hpp". Register `power_user::app` if an interrupt source of your own
+  // needs the I/O clock to wake the MCU.
+  //
+  // If the system is overloaded, new tasks will not be admitted. If the overload comes from an
+  // ISR scheduling the same task over and over, consider flag_scheduler from "sched_flags.hpp".
+  //
+  // It does not support scheduling tasks in the future, use timer_scheduler
+  // from "sched_timer.hpp" if you need that. For this reason
   // this scheduler is mainly useful with an interrupt driven design
   // where an interrupt schedules a new task. If the scheduler was sleeping
   // upon return from the ISR the MCU will be awake again and scheduling
@@ -33,11 +49,17 @@ namespace xtd {
   // polling task schedule itself after it is done and let IRQs schedule
   // your other sporadic tasks.
   //
+  // Per task run time, dispatch latency and queue usage can be recorded by passing
+  // xtd::sched_stats as `stats_`, see "sched_stats.hpp". The default policy records nothing and
+  // costs nothing.
+  //
   // This code assumes single threaded MCU.
-  template <fast_size_t max_tasks_>
-  class fcfs_scheduler {
+  template <fast_size_t max_tasks_, typename task_type_ = void (*)(void),
+            typename stats_ = no_sched_stats>
+  class fcfs_scheduler : private stats_ {
   public:
-    using task_type = void (*)(void);
+    using task_type = task_type_;
+    using stats_type = stats_;
 
     __attribute__((noreturn)) void run() {
       // Interrupts are disabled while we're in the main body and enabled
@@ -46,17 +68,14 @@ namespace xtd {
 
       while (true) {
         if (tasks.empty()) {
-          sleep_enable();
-          set_sleep_mode(SLEEP_MODE_IDLE);
-          sei();  // Interrups enabled while sleeping
-          sleep_cpu();
-          cli();
-          sleep_disable();
+          power_sleep(power_deepest_sleep_mode());
         } else {
-          auto t = tasks.get();
+          const auto e = tasks.get();
+          stats_::on_dispatch(e);
           sei();  // Interrupts enabled while executing task
-          t();
+          stats_::entry_task(e)();
           cli();
+          stats_::on_complete();
         }
       }
     }
@@ -64,18 +83,23 @@ namespace xtd {
     // Schedules the task to be executed after priori scheduled tasks are done.
     // Returns false if the task was not admitted due to overload.
     // May be called safely from ISRs.
-    bool schedule(task_type t) {
+    bool schedule(const task_type& t) {
       ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
         if (!tasks.full()) {
-          tasks.push(t);
+          tasks.push(stats_::make_entry(t));
+          stats_::on_schedule(tasks.size());
           return true;
         }
+        stats_::on_reject();
         return false;
       }
     }
 
+    // The recorded statistics, see `stats_`.
+    const stats_type& stats() const { return *this; }
+
   private:
-    xtd::queue<task_type, max_tasks_> tasks;
+    xtd::queue<typename stats_::template entry<task_type>, max_tasks_> tasks;
   };
 
 }  // namespace xtd
@@ -0,0 +1,144 @@
+#ifndef XTD_UC_SCHED_FLAGS_HPP
+#define XTD_UC_SCHED_FLAGS_HPP
+#include "common.hpp"
+
+#include "bit.hpp"
+#include "cstdint.hpp"
+#include "power.hpp"
+#include "type_traits.hpp"
+
+#ifdef ENABLE_TEST
+#include "fake_avr.hpp"
+#else
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#endif
+
+namespace xtd {
+  namespace detail {
+    template <typename T, T needle, T... haystack>
+    struct index_of;
+
+    template <typename T, T needle, T... rest>
+    struct index_of<T, needle, needle, rest...> : integral_constant<uint8_t, 0> {};
+
+    template <typename T, T needle, T first, T... rest>
+    struct index_of<T, needle, first, rest...>
+        : integral_constant<uint8_t, 1 + index_of<T, needle, rest...>::value> {};
+
+    template <fast_size_t n>
+    using flag_mask_t =
+        conditional_t<(n <= 8), uint8_t, conditional_t<(n <= 16), uint16_t, uint32_t>>;
+  }  // namespace detail
+
+  // A non-preemptive scheduler for a fixed set of tasks, known at compile time, where each task
+  // is one bit in a pending mask.
+  //
+  // Posting a task sets its bit, posting a task that is already pending does nothing. This means
+  // that an ISR that fires repeatedly, for example on every received UART byte, cannot overload
+  // the scheduler, the task simply runs once and should process everything that arrived since it
+  // last ran. The bit is cleared before the task starts, so a post during the execution of the task
+  // makes it run again.
+  //
+  // At each scheduling event the pending task with the lowest index in `tasks` is executed until
+  // it completes, without pre-emption, so the order of `tasks` is also their priority. When a task
+  // starts execution, global interrupts are always enabled. When no task is pending the MCU sleeps
+  // in the deepest sleep mode allowed by the active peripherals, see "power.hpp".
+  //
+  // Example:
+  //     void on_rx();
+  //     void on_adc();
+  //     xtd::flag_scheduler<on_rx, on_adc> scheduler;
+  //
+  //     ISR(USART_RX_vect) {
+  //       rx_buffer.push(UDR0);
+  //       scheduler.post_from_isr<on_rx>();
+  //     }
+  //
+  // Up to 32 tasks are supported, the pending mask is the smallest unsigned type that fits.
+  //
+  // This code assumes single threaded MCU.
+  template <void (*... tasks)()>
+  class flag_scheduler {
+  public:
+    using task_type = void (*)(void);
+
+    static_assert(sizeof...(tasks) >= 1 && sizeof...(tasks) <= 32,
+                  "Between 1 and 32 tasks supported!");
+
+    __attribute__((noreturn)) void run() {
+      // Interrupts are disabled while we're in the main body and enabled
+      // when we go to sleep or execute a task (i.e. most of the time)
+      cli();
+
+      while (true) {
+        if (!run_once()) {
+          power_sleep(power_deepest_sleep_mode());
+        }
+      }
+    }
+
+    // Marks the task as pending.
+    // May be called safely from ISRs, but post_from_isr() is cheaper there.
+    template <task_type task>
+    void post() {
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { post_from_isr<task>(); }
+    }
+
+    // Marks the task as pending.
+    // Must be called with interrupts disabled, e.g. from an ISR.
+    template <task_type task>
+    void post_from_isr() {
+      m_pending |= bit<task>();
+    }
+
+    // Returns true if the task is pending.
+    template <task_type task>
+    bool pending() const {
+      return (m_pending & bit<task>()) != 0;
+    }
+
+  protected:
+    // Runs the pending task with the lowest index, if any. Returns false if there was nothing to
+    // run.
+    // Must be called with interrupts disabled.
+    bool run_once() {
+      if (m_pending == 0) {
+        return false;
+      }
+      const auto i = countr_zero(mask_type(m_pending));
+      m_pending &= mask_type(~(mask_type(1) << i));
+      sei();  // Interrupts enabled while executing task
+      dispatch<0, tasks...>(i);
+      cli();
+      return true;
+    }
+
+  private:
+    using mask_type = detail::flag_mask_t<sizeof...(tasks)>;
+
+    template <task_type task>
+    constexpr static mask_type bit() {
+      return mask_type(mask_type(1) << detail::index_of<task_type, task, tasks...>::value);
+    }
+
+    // Resolves the index to a direct call, the compiler turns this into a compare chain and no
+    // table of function pointers needs to be kept in RAM.
+    template <uint8_t n, task_type first, task_type... rest>
+    static void dispatch(uint8_t i) {
+      if (i == n) {
+        first();
+      } else {
+        dispatch<n + 1, rest...>(i);
+      }
+    }
+
+    template <uint8_t n>
+    static void dispatch(uint8_t) {}
+
+    volatile mask_type m_pending = 0;
+  };
+
+}  // namespace xtd
+
+#endif
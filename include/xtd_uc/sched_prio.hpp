@@ -0,0 +1,109 @@
+#ifndef XTD_UC_SCHED_PRIO_HPP
+#define XTD_UC_SCHED_PRIO_HPP
+#include "common.hpp"
+
+#include "bit.hpp"
+#include "cstdint.hpp"
+#include "power.hpp"
+#include "queue.hpp"
+
+#ifdef ENABLE_TEST
+#include "fake_avr.hpp"
+#else
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#endif
+
+namespace xtd {
+  // A non-preemptive, fixed priority scheduler.
+  //
+  // There are `levels_` priority levels, level 0 being the highest priority. Each level has its
+  // own First Come First Serve queue of up to `max_tasks_per_level_` tasks. At each scheduling
+  // event (previous task completed, resume from wait, system start) the oldest task of the highest
+  // priority level that has any tasks is executed until it completes, without pre-emption. When a
+  // task starts execution, global interrupts are always enabled.
+  //
+  // A bit mask tracks which levels have ready tasks, so picking the next level is a single read
+  // from a 2^levels_ byte table in program memory. Keep the number of levels small (4 is a good
+  // choice) as the table grows quickly.
+  //
+  // Note that a steady stream of high priority tasks will starve lower priority tasks.
+  //
+  // Note that it may be necessary to annotate your task functions with
+  // __attribute__((used)) to prevent the linker removing it if there
+  // are no direct calls to it outside of the scheduler.
+  //
+  // When there are no tasks the MCU sleeps in the deepest sleep mode allowed by the active
+  // peripherals, see "power.hpp".
+  //
+  // If a priority level is overloaded, new tasks will not be admitted to it.
+  //
+  // This code assumes single threaded MCU.
+  template <fast_size_t levels_, fast_size_t max_tasks_per_level_>
+  class priority_scheduler {
+  public:
+    using task_type = void (*)(void);
+
+    static_assert(levels_ >= 1 && levels_ <= 8, "Between 1 and 8 priority levels supported!");
+
+    __attribute__((noreturn)) void run() {
+      // Interrupts are disabled while we're in the main body and enabled
+      // when we go to sleep or execute a task (i.e. most of the time)
+      cli();
+
+      while (true) {
+        if (!run_once()) {
+          power_sleep(power_deepest_sleep_mode());
+        }
+      }
+    }
+
+    // Schedules the task to be executed after all tasks of a higher priority and all priori
+    // scheduled tasks of the same priority are done. Priority 0 is the highest.
+    // Returns false if the task was not admitted due to overload or if the priority is not one
+    // of the `levels_` levels.
+    // May be called safely from ISRs.
+    bool schedule(task_type t, fast_size_t priority) {
+      if (priority >= levels_) {
+        return false;
+      }
+      bool admitted = false;
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        auto& q = tasks[priority];
+        if (!q.full()) {
+          q.push(t);
+          m_ready |= uint8_t(1 << priority);
+          admitted = true;
+        }
+      }
+      return admitted;
+    }
+
+  protected:
+    // Runs the oldest task of the highest priority level, if any. Returns false if there was
+    // nothing to run.
+    // Must be called with interrupts disabled.
+    bool run_once() {
+      if (m_ready == 0) {
+        return false;
+      }
+      const auto level = countr_zero_bits<levels_>(m_ready);
+      auto& q = tasks[level];
+      auto t = q.get();
+      if (q.empty()) {
+        m_ready &= uint8_t(~(1 << level));
+      }
+      sei();  // Interrupts enabled while executing task
+      t();
+      cli();
+      return true;
+    }
+
+  private:
+    xtd::queue<task_type, max_tasks_per_level_> tasks[levels_];
+    uint8_t m_ready = 0;  // Bit i is set if tasks[i] is not empty.
+  };
+
+}  // namespace xtd
+
+#endif
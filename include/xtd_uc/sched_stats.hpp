@@ -0,0 +1,179 @@
+#ifndef XTD_UC_SCHED_STATS_HPP
+#define XTD_UC_SCHED_STATS_HPP
+#include "common.hpp"
+
+#include "chrono.hpp"
+#include "cstdint.hpp"
+
+namespace xtd {
+  // Instrumentation policy for the schedulers that records nothing.
+  //
+  // All hooks are empty and inlined away, and as the schedulers inherit from their policy it takes
+  // no space either.
+  struct no_sched_stats {
+    // The type stored in the task queue for a task of type Task.
+    template <typename Task>
+    using entry = Task;
+
+    template <typename Task>
+    const Task& make_entry(const Task& t) const {
+      return t;
+    }
+
+    template <typename Task>
+    static const Task& entry_task(const Task& e) {
+      return e;
+    }
+
+    void on_schedule(fast_size_t) {}
+    void on_reject() {}
+    template <typename Task>
+    void on_dispatch(const Task&) {}
+    void on_complete() {}
+  };
+
+  namespace detail {
+    template <typename Task>
+    struct stamped_task {
+      Task task;
+      uint16_t enqueued;  // Low 16 bits of the clock ticks when the task was scheduled
+    };
+  }  // namespace detail
+
+  // Instrumentation policy for the schedulers that records per task statistics.
+  //
+  // Usage:
+  //     using stats = xtd::sched_stats<8>;
+  //     xtd::fcfs_scheduler<8, void (*)(), stats> scheduler;
+  //
+  //     void dump_stats() {
+  //       for (const auto& s : scheduler.stats()) {
+  //         // s.task, s.calls, s.max_run, s.total_run, s.max_latency
+  //       }
+  //     }
+  //
+  // For each of the first `slots_` distinct tasks that are dispatched, the number of calls, the
+  // maximum and total run time and the maximum latency from schedule() to dispatch are recorded,
+  // all in Clock ticks. Tasks beyond the first `slots_` are only counted in the scheduler wide
+  // figures: the queue high-water mark and the number of rejected schedule() calls.
+  //
+  // Every queued task is stamped with the low 16 bits of the clock, so each queue slot grows by 2
+  // bytes. Run times and latencies longer than 65535 ticks (4.2 s with the steady_clock at 16 MHz)
+  // are not recorded correctly. Counters saturate instead of wrapping around.
+  //
+  // The statistics are updated by the scheduler with interrupts disabled, the multi byte values
+  // should be read with interrupts disabled as well to get consistent values.
+  template <fast_size_t slots_, typename Task = void (*)(void),
+            typename Clock = chrono::steady_clock>
+  class sched_stats {
+  public:
+    struct task_stats {
+      Task task;
+      uint16_t calls;
+      uint16_t max_run;
+      uint32_t total_run;
+      uint16_t max_latency;
+    };
+
+    template <typename T>
+    using entry = detail::stamped_task<T>;
+
+    entry<Task> make_entry(const Task& t) const { return {t, ticks()}; }
+
+    static const Task& entry_task(const entry<Task>& e) { return e.task; }
+
+    void on_schedule(fast_size_t queued) {
+      if (queued > m_high_water) {
+        m_high_water = queued;
+      }
+    }
+
+    void on_reject() {
+      if (m_rejected != 0xFFFF) {
+        m_rejected++;
+      }
+    }
+
+    void on_dispatch(const entry<Task>& e) {
+      m_start = ticks();
+      m_current = slot(e.task);
+      if (m_current) {
+        const auto latency = uint16_t(m_start - e.enqueued);
+        if (latency > m_current->max_latency) {
+          m_current->max_latency = latency;
+        }
+      }
+    }
+
+    void on_complete() {
+      if (!m_current) {
+        return;
+      }
+      const auto run = uint16_t(ticks() - m_start);
+      if (run > m_current->max_run) {
+        m_current->max_run = run;
+      }
+      if (m_current->total_run <= 0xFFFFFFFF - run) {
+        m_current->total_run += run;
+      }
+      if (m_current->calls != 0xFFFF) {
+        m_current->calls++;
+      }
+    }
+
+    // The recorded tasks in the order they were first dispatched.
+    const task_stats* begin() const { return m_tasks; }
+    const task_stats* end() const { return m_tasks + m_used; }
+    fast_size_t size() const { return m_used; }
+
+    // Returns the statistics of the given task or nullptr if it hasn't been recorded.
+    const task_stats* find(const Task& t) const {
+      for (auto& s : *this) {
+        if (s.task == t) {
+          return &s;
+        }
+      }
+      return nullptr;
+    }
+
+    // The largest number of tasks that have been waiting in the queue at the same time.
+    fast_size_t high_water_mark() const { return m_high_water; }
+
+    // The number of schedule() calls that were rejected because the queue was full.
+    uint16_t rejected() const { return m_rejected; }
+
+    // Clears all statistics.
+    void reset() {
+      m_used = 0;
+      m_current = nullptr;
+      m_high_water = 0;
+      m_rejected = 0;
+    }
+
+  private:
+    static uint16_t ticks() { return uint16_t(Clock::now().time_since_epoch().count()); }
+
+    task_stats* slot(const Task& t) {
+      for (fast_size_t i = 0; i < m_used; ++i) {
+        if (m_tasks[i].task == t) {
+          return &m_tasks[i];
+        }
+      }
+      if (m_used == slots_) {
+        return nullptr;
+      }
+      auto& s = m_tasks[m_used++];
+      s = task_stats{t, 0, 0, 0, 0};
+      return &s;
+    }
+
+    task_stats m_tasks[slots_];
+    fast_size_t m_used = 0;
+    task_stats* m_current = nullptr;
+    uint16_t m_start = 0;
+    fast_size_t m_high_water = 0;
+    uint16_t m_rejected = 0;
+  };
+}  // namespace xtd
+
+#endif
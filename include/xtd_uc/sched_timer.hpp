@@ -0,0 +1,214 @@
+#ifndef XTD_UC_SCHED_TIMER_HPP
+#define XTD_UC_SCHED_TIMER_HPP
+#include "common.hpp"
+
+#include "chrono.hpp"
+#include "cstdint.hpp"
+#include "power.hpp"
+#include "queue.hpp"
+
+#ifdef ENABLE_TEST
+#include "fake_avr.hpp"
+#else
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#endif
+
+namespace xtd {
+  // A non-preemptive, First Come First Serve (FCFS) scheduler that can also schedule tasks
+  // at, or periodically from, a point in time in the future.
+  //
+  // Tasks that are ready to run are executed in the order they became ready, until they complete
+  // and without pre-emption, exactly like fcfs_scheduler. Tasks scheduled for the future are kept
+  // in a fixed capacity table sorted by deadline. When a deadline passes the task is moved to the
+  // back of the ready queue, a periodic task is then immediately re-armed one period after its
+  // previous deadline, so that it doesn't drift.
+  //
+  // When there is nothing to run the MCU sleeps until the next interrupt. The steady_clock wakes
+  // the MCU at least once every steady_clock::irq_period and the scheduler arms a compare match
+  // interrupt when the nearest deadline is closer than that, so tasks are started within a couple
+  // of clock ticks of their deadline without busy waiting. The sleep mode is the deepest one
+  // allowed by the active peripherals, see "power.hpp", but no deeper than Idle
+  // when the nearest deadline is closer than the time the MCU clock needs to start up.
+  //
+  // Note that it may be necessary to annotate your task functions with
+  // __attribute__((used)) to prevent the linker removing it if there
+  // are no direct calls to it outside of the scheduler.
+  //
+  // If the system is overloaded, new tasks will not be admitted. Timers that expire while the
+  // ready queue is full stay in the timer table until there is room.
+  //
+  // Using this scheduler reserves TIMER2 for the steady_clock, you must build and link
+  // "chrono.cpp".
+  //
+  // This code assumes single threaded MCU.
+  //
+  // The clock_ template parameter is for testing.
+  template <fast_size_t max_tasks_, fast_size_t max_timers_,
+            typename clock_ = chrono::steady_clock>
+  class timer_scheduler {
+  public:
+    using task_type = void (*)(void);
+    using clock = clock_;
+    using time_point = typename clock::time_point;
+    using duration = typename clock::duration;
+
+    __attribute__((noreturn)) void run() {
+      // Interrupts are disabled while we're in the main body and enabled
+      // when we go to sleep or execute a task (i.e. most of the time)
+      cli();
+
+      while (true) {
+        if (!run_once()) {
+          sleep();
+        }
+      }
+    }
+
+    // Schedules the task to be executed after priori scheduled tasks are done.
+    // Returns false if the task was not admitted due to overload.
+    // May be called safely from ISRs.
+    bool schedule(task_type t) {
+      bool admitted = false;
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (!tasks.full()) {
+          tasks.push(t);
+          admitted = true;
+        }
+      }
+      return admitted;
+    }
+
+    // Schedules the task to become ready at the given time point. A time point in the past makes
+    // the task ready at the next scheduling event.
+    // Returns false if the task was not admitted because the timer table is full.
+    // May be called safely from ISRs.
+    bool schedule_at(const time_point& when, task_type t) {
+      bool admitted;
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { admitted = insert(timer{when, duration(0), t}); }
+      return admitted;
+    }
+
+    // Schedules the task to become ready after the given duration has passed.
+    // Returns false if the task was not admitted because the timer table is full.
+    // May be called safely from ISRs.
+    bool schedule_after(const duration& d, task_type t) {
+      return schedule_at(time_point(clock::now().time_since_epoch() + d), t);
+    }
+
+    // Schedules the task to become ready every `period`, starting one period from now.
+    // The task keeps its slot in the timer table until it is cancelled.
+    // Returns false if the task was not admitted because the timer table is full.
+    // May be called safely from ISRs.
+    bool schedule_every(const duration& period, task_type t) {
+      bool admitted;
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        admitted = insert(timer{time_point(clock::now().time_since_epoch() + period), period, t});
+      }
+      return admitted;
+    }
+
+    // Removes all pending timers, one-shot or periodic, for the given task. Does not affect a task
+    // that has already become ready.
+    // May be called safely from ISRs.
+    void cancel(task_type t) {
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        fast_size_t kept = 0;
+        for (fast_size_t i = 0; i < m_timers; ++i) {
+          if (timers[i].task != t) {
+            timers[kept++] = timers[i];
+          }
+        }
+        m_timers = kept;
+      }
+    }
+
+  protected:
+    // Moves expired timers to the ready queue and runs the oldest ready task, if any. Returns
+    // false if there was nothing to run.
+    // Must be called with interrupts disabled.
+    bool run_once() {
+      expire_timers();
+      if (tasks.empty()) {
+        return false;
+      }
+      auto t = tasks.get();
+      sei();  // Interrupts enabled while executing task
+      t();
+      cli();
+      return true;
+    }
+
+    // Sleeps until the next interrupt, after arming the clock to wake the MCU at the nearest
+    // deadline. Returns false without sleeping if that deadline has already passed.
+    // Must be called with interrupts disabled.
+    bool sleep() {
+      if (m_timers == 0) {
+        power_sleep(power_deepest_sleep_mode());
+        return true;
+      }
+      const auto deadline = timers[m_timers - 1].deadline;
+      // The deadline may pass while the compare match is armed, wake_at() then fails and nothing
+      // would wake the MCU before the next overflow interrupt. Re-check the time after arming, a
+      // match after this point leaves its interrupt pending which ends the sleep immediately.
+      clock::wake_at(deadline);
+      const auto until_deadline = deadline - clock::now();
+      if (until_deadline.count() <= 0) {
+        return false;
+      }
+      power_sleep(power_deepest_sleep_mode(until_deadline));
+      return true;
+    }
+
+  private:
+    struct timer {
+      time_point deadline;
+      duration period;  // Zero for one-shot timers
+      task_type task;
+    };
+
+    xtd::queue<task_type, max_tasks_> tasks;
+
+    // Sorted with the latest deadline first, so that the nearest deadline is removed from the end
+    // of the table without moving the other timers.
+    timer timers[max_timers_];
+    fast_size_t m_timers = 0;
+
+    // Must be called with interrupts disabled.
+    bool insert(const timer& t) {
+      if (m_timers == max_timers_) {
+        return false;
+      }
+      auto i = m_timers;
+      while (i > 0 && timers[i - 1].deadline < t.deadline) {
+        timers[i] = timers[i - 1];
+        --i;
+      }
+      timers[i] = t;
+      m_timers++;
+      return true;
+    }
+
+    // Must be called with interrupts disabled.
+    void expire_timers() {
+      if (m_timers == 0) {
+        return;
+      }
+      const auto now = clock::now();
+      while (m_timers > 0 && !tasks.full()) {
+        const auto t = timers[m_timers - 1];
+        if (now < t.deadline) {
+          return;
+        }
+        m_timers--;
+        tasks.push(t.task);
+        if (t.period.count() > 0) {
+          insert(timer{time_point(t.deadline.time_since_epoch() + t.period), t.period, t.task});
+        }
+      }
+    }
+  };
+
+}  // namespace xtd
+
+#endif
@@ -0,0 +1,212 @@
+#ifndef XTD_UC_SLIP_HPP
+#define XTD_UC_SLIP_HPP
+#include "common.hpp"
+
+#include "crc.hpp"
+#include "cstdint.hpp"
+
+#ifdef ENABLE_TEST
+#include "fake_avr.hpp"
+#else
+#include <util/atomic.h>
+#endif
+
+// SLIP (RFC 1055) framing of binary data with a trailing CRC-16/CCITT, see "crc.hpp".
+//
+// On the wire a frame is:
+//
+//     END, escaped(data..., crc_hi, crc_lo), END
+//
+// Where every END (0xC0) in the payload is sent as ESC (0xDB) ESC_END (0xDC) and every ESC as
+// ESC ESC_ESC (0xDD). The leading END flushes any line noise received before the frame.
+//
+// SLIP is used rather than COBS because it can be encoded one byte at a time, COBS needs to see
+// up to 254 bytes ahead to emit the first code byte which means buffering the frame once more.
+// The cost is that the worst case overhead is 2x rather than 1 byte in 254.
+
+namespace xtd {
+  namespace slip {
+    constexpr uint8_t end = 0xC0;
+    constexpr uint8_t esc = 0xDB;
+    constexpr uint8_t esc_end = 0xDC;
+    constexpr uint8_t esc_esc = 0xDD;
+  }  // namespace slip
+
+  // Encodes frames directly onto a byte sink, for example uart_put(), without buffering them.
+  //
+  // Example:
+  //     xtd::slip_encoder<xtd::uart_put> tx;
+  //     tx.begin();
+  //     tx.write(reinterpret_cast<const uint8_t*>(&sample), sizeof(sample));
+  //     tx.put(status);
+  //     tx.end();
+  template <void (*sink)(char)>
+  class slip_encoder {
+  public:
+    // Starts a new frame.
+    void begin() {
+      m_crc.reset();
+      sink(char(slip::end));
+    }
+
+    // Appends one byte of payload to the current frame.
+    void put(uint8_t data) {
+      m_crc.put(data);
+      put_escaped(data);
+    }
+
+    void write(const uint8_t* data, size_t len) {
+      while (len--) {
+        put(*data++);
+      }
+    }
+
+    // Appends the CRC and terminates the frame.
+    void end() {
+      const auto crc = m_crc.value();
+      put_escaped(uint8_t(crc >> 8));
+      put_escaped(uint8_t(crc));
+      sink(char(slip::end));
+    }
+
+  private:
+    static void put_escaped(uint8_t data) {
+      if (data == slip::end) {
+        sink(char(slip::esc));
+        sink(char(slip::esc_end));
+      } else if (data == slip::esc) {
+        sink(char(slip::esc));
+        sink(char(slip::esc_esc));
+      } else {
+        sink(char(data));
+      }
+    }
+
+    crc16_ccitt m_crc;
+  };
+
+  // The result of feeding one byte to a slip_decoder.
+  enum class slip_status : uint8_t {
+    pending,      // The byte was consumed, no frame has been completed
+    frame,        // A frame with a valid CRC is available in data()
+    crc_error,    // A frame was discarded because the CRC didn't match or it was too short
+    overrun,      // A frame was discarded because it didn't fit, or arrived before release()
+    escape_error  // A frame was discarded because of an invalid escape sequence
+  };
+
+  // Decodes frames one byte at a time, directly into its own buffer of `max_len` payload bytes.
+  // The CRC is checked as the bytes arrive so the frame is never traversed twice.
+  //
+  // push() is meant to be called from the RX ISR (or the uart_rx_callback). When it returns
+  // slip_status::frame, data() and size() are valid and stay so until release() is called; any
+  // frame that arrives before then is dropped and reported as an overrun. push() and release()
+  // must not be called concurrently, but release() may be called from the main context while
+  // push() is called from an ISR.
+  //
+  // Example:
+  //     xtd::slip_decoder<32> rx;
+  //
+  //     void on_rx(char c, xtd::uart_rx_status) {
+  //       if (rx.push(c) == xtd::slip_status::frame) {
+  //         scheduler.post_from_isr<handle_frame>();
+  //       }
+  //     }
+  //
+  //     void handle_frame() {
+  //       process(rx.data(), rx.size());
+  //       rx.release();
+  //     }
+  template <uint8_t max_len>
+  class slip_decoder {
+  public:
+    static_assert(max_len <= 253, "The payload and CRC must fit in 255 bytes!");
+
+    using size_type = uint8_t;
+
+    slip_status push(uint8_t byte) {
+      if (byte == slip::end) {
+        return end_of_frame();
+      }
+
+      if (m_state & escape) {
+        m_state &= uint8_t(~escape);
+        if (byte == slip::esc_end) {
+          byte = slip::end;
+        } else if (byte == slip::esc_esc) {
+          byte = slip::esc;
+        } else {
+          m_state |= bad_escape;
+        }
+      } else if (byte == slip::esc) {
+        m_state |= escape;
+        return slip_status::pending;
+      }
+
+      if (m_state & (ready | discard)) {
+        m_state |= discard;
+        return slip_status::pending;
+      }
+      if (m_len == sizeof(m_data)) {
+        m_state |= discard;
+        return slip_status::pending;
+      }
+      m_crc = crc16_ccitt::update(m_crc, byte);
+      m_data[m_len++] = byte;
+      return slip_status::pending;
+    }
+
+    // The payload of the last completed frame, without the CRC. Only valid after push() has
+    // returned slip_status::frame and until release() is called.
+    const uint8_t* data() const { return m_data; }
+    size_type size() const { return m_size; }
+    bool available() const { return (m_state & ready) != 0; }
+
+    // Hands the buffer back to the decoder so that it can receive the next frame.
+    // May be called while push() is called from an ISR, which also modifies the state.
+    void release() {
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        m_size = 0;
+        m_state &= uint8_t(~ready);
+      }
+    }
+
+  private:
+    constexpr static uint8_t ready = 1;
+    constexpr static uint8_t escape = 2;
+    constexpr static uint8_t discard = 4;
+    constexpr static uint8_t bad_escape = 8;
+
+    slip_status end_of_frame() {
+      const uint8_t len = m_len;
+      const uint8_t state = m_state;
+      const bool crc_ok = m_crc == 0;
+      m_len = 0;
+      m_crc = crc16_ccitt::initial;
+      m_state = uint8_t(state & ready);
+
+      if (state & discard) {
+        return slip_status::overrun;
+      }
+      if (state & (bad_escape | escape)) {
+        return slip_status::escape_error;
+      }
+      if (len == 0) {
+        return slip_status::pending;  // Back to back END bytes are allowed
+      }
+      if (len < 2 || !crc_ok) {
+        return slip_status::crc_error;
+      }
+      m_size = uint8_t(len - 2);
+      m_state |= ready;
+      return slip_status::frame;
+    }
+
+    uint8_t m_data[max_len + 2];
+    volatile uint8_t m_state = 0;
+    uint8_t m_len = 0;
+    uint8_t m_size = 0;
+    uint16_t m_crc = crc16_ccitt::initial;
+  };
+}  // namespace xtd
+
+#endif
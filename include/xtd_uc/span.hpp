@@ -0,0 +1,56 @@
+#ifndef XTD_UC_SPAN_HPP
+#define XTD_UC_SPAN_HPP
+#include "common.hpp"
+
+#include "cstdint.hpp"
+
+namespace xtd {
+  // A non-owning view of a contiguous sequence of objects.
+  //
+  // Non-compliance: only dynamic extent is supported.
+  template <typename T>
+  class span {
+  public:
+    using element_type = T;
+    using size_type = xtd::size_t;
+    using pointer = T*;
+    using reference = T&;
+    using iterator = T*;
+
+    constexpr span() = default;
+    constexpr span(pointer data, size_type size) : m_data(data), m_size(size) {}
+    template <size_type N>
+    constexpr span(T (&array)[N]) : m_data(array), m_size(N) {}
+
+    constexpr pointer data() const { return m_data; }
+    constexpr size_type size() const { return m_size; }
+    constexpr bool empty() const { return m_size == 0; }
+
+    constexpr iterator begin() const { return m_data; }
+    constexpr iterator end() const { return m_data + m_size; }
+
+    constexpr reference operator[](size_type i) const { return m_data[i]; }
+
+    constexpr span first(size_type n) const { return span(m_data, n); }
+    constexpr span subspan(size_type offset) const { return span(m_data + offset, m_size - offset); }
+
+  private:
+    pointer m_data = nullptr;
+    size_type m_size = 0;
+  };
+
+  // A range of a circular buffer, split in two contiguous spans at the wraparound point.
+  //
+  // The `first` span comes before the `second` span in queue order, if the range doesn't wrap
+  // around then `second` is empty.
+  template <typename T>
+  struct ring_span {
+    span<T> first;
+    span<T> second;
+
+    constexpr xtd::size_t size() const { return first.size() + second.size(); }
+    constexpr bool empty() const { return size() == 0; }
+  };
+}  // namespace xtd
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef XTD_UC_SPSC_QUEUE_HPP
+#define XTD_UC_SPSC_QUEUE_HPP
+#include "common.hpp"
+
+#include "cstdint.hpp"
+
+namespace xtd {
+  namespace detail {
+    // Prevents the compiler from moving memory accesses across this point. The AVR core executes
+    // in order so this is all that is needed to publish data to an ISR or vice versa.
+    inline void compiler_barrier() { __asm__ __volatile__("" ::: "memory"); }
+  }  // namespace detail
+
+  // A bounded single-producer/single-consumer queue implemented using a circular buffer.
+  //
+  // This queue is intended for handing data between an ISR and the main program without disabling
+  // interrupts. Exactly one context (e.g. the main program) may call the producer methods and
+  // exactly one other context (e.g. an ISR) may call the consumer methods:
+  // * Producer: push(), try_push(), push_n(), full()
+  // * Consumer: peek(), pop(), get(), empty()
+  // * Either: size(), capacity()
+  //
+  // The write index is only ever written by the producer and the read index only by the consumer.
+  // Both are single byte volatile variables so they are read and written atomically on AVR. An
+  // element is written before the write index is published and read before the read index is
+  // released, so neither side ever observes a half written element.
+  //
+  // The indices are free running and wrapped with a mask, this means that all N elements are
+  // usable and the code is free from divisions. The size() seen by one side may be stale, but only
+  // in the conservative direction: the producer may see the queue as fuller than it is and the
+  // consumer may see it as emptier than it is.
+  //
+  // The type of T must be:
+  // * default constructible
+  // * trivially destructible
+  // * copy assignible
+  //
+  // N must be a power of two, no larger than 128.
+  template <typename T, fast_size_t N>
+  class spsc_queue {
+  public:
+    using size_type = fast_size_t;
+
+    static_assert(N > 0 && (N & (N - 1)) == 0, "N must be a power of two!");
+    static_assert(N <= 128, "N must fit the free running index range!");
+
+    size_type capacity() const { return N; }
+
+    size_type size() const { return size_type(m_write - m_read); }
+
+    // Empties the queue (objects in the queue are not destructed).
+    // Must not be called while the other side may access the queue.
+    void clear() {
+      m_read = 0;
+      m_write = 0;
+    }
+
+    // Pushes a new value onto the queue.
+    // If the queue is full() then pushing a new value is undefined behaviour.
+    void push(const T& v) {
+      const size_type w = m_write;
+      buffer[w & mask] = v;
+      detail::compiler_barrier();
+      m_write = size_type(w + 1);
+    }
+
+    // Pushes a new value onto the queue if there is room for it.
+    // Returns false if the queue was full.
+    bool try_push(const T& v) {
+      if (full()) {
+        return false;
+      }
+      push(v);
+      return true;
+    }
+
+    // Pushes up to n values from src onto the queue, they are published to the consumer together.
+    // Returns the number of values pushed, which is less than n if the queue became full.
+    size_type push_n(const T* src, size_type n) {
+      const size_type w = m_write;
+      const auto room = size_type(N - size_type(w - m_read));
+      if (n > room) {
+        n = room;
+      }
+      for (size_type i = 0; i < n; ++i) {
+        buffer[(w + i) & mask] = src[i];
+      }
+      detail::compiler_barrier();
+      m_write = size_type(w + n);
+      return n;
+    }
+
+    // Removes the front element from the queue.
+    void pop() {
+      detail::compiler_barrier();
+      m_read = size_type(m_read + 1);
+    }
+
+    // Returns true if the queue is full and unable to accept another element.
+    bool full() const { return size() == capacity(); }
+
+    // Returns true if the queue is empty.
+    bool empty() const { return m_read == m_write; }
+
+    // Steal the next element from the queue (the element is removed from the queue).
+    // If the queue is empty() then this causes undefined behaviour.
+    T get() {
+      auto ans = peek();
+      pop();
+      return ans;
+    }
+
+    // Look at the next element of the queue without removing it.
+    // IF the queue is empty() then this causes undefined behaviour.
+    T& peek() { return buffer[m_read & mask]; }
+
+  private:
+    constexpr static size_type mask = N - 1;
+
+    T buffer[N];
+    volatile size_type m_read = 0;
+    volatile size_type m_write = 0;
+  };
+}  // namespace xtd
+
+#endif
@@ -412,6 +412,15 @@ struct is_function<Ret(Args......) const volatile&& noexcept> : true_type {};
   template <typename T>
   struct is_signed : detail::is_signed<T>::type {};
 
+  // ---------------------------------------------------------------------------
+  // type properties
+  // ---------------------------------------------------------------------------
+  template <class T>
+  struct is_trivially_copyable : bool_constant<__is_trivially_copyable(T)> {};
+
+  template <class T>
+  /*inline*/ constexpr bool is_trivially_copyable_v = is_trivially_copyable<T>::value;
+
 }  // namespace xtd
 
 #endif
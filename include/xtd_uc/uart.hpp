@@ -5,7 +5,9 @@
 #include <avr/pgmspace.h>
 #include <stdint.h>
 #include "chrono_noclock.hpp"
+#include "istream.hpp"
 #include "ostream.hpp"
+#include "usart.hpp"
 
 #if UART_BAUD < 1
 #define UART_BAUD 9600
@@ -27,36 +29,47 @@
 #define UART_SYNC false
 #endif
 
-#ifndef UART_X2
-#define UART_X2 false
+// UART_X2 may be defined to true or false to force the double speed or the normal mode. By default
+// the mode with the lowest baud rate error is used, see uart_baud in "usart.hpp".
+
+// Size of the optional RX buffer, a power of two up to 128. When 0, which is the default, no buffer
+// is allocated and received bytes can only be handled through the uart_rx_callback.
+#ifndef UART_RX_BUFFER_LEN
+#define UART_RX_BUFFER_LEN 0
 #endif
 
 namespace xtd {
 
+#ifdef UART_X2
   static_assert(!(UART_SYNC && UART_X2), "X2 cannot be enabled with SYNC");
+  constexpr static uart_speed uart_speed_mode = UART_X2 ? uart_speed::x2 : uart_speed::normal;
+#else
+  constexpr static uart_speed uart_speed_mode = uart_speed::automatic;
+#endif
   static_assert(5 <= UART_DATA_BITS && UART_DATA_BITS <= 8, "Only 5-8 bit data supported!");
   static_assert(1 == UART_STOP_BITS || 2 == UART_STOP_BITS, "Only 1 or 2 stop bits possible!");
   static_assert(0 <= UART_PARITY_BITS && UART_PARITY_BITS <= 2, "Only 0, 1 or 2 parity!");
+  static_assert((UART_RX_BUFFER_LEN & (UART_RX_BUFFER_LEN - 1)) == 0 && UART_RX_BUFFER_LEN <= 128,
+                "The RX buffer length must be 0 or a power of two up to 128!");
 
-  enum uart_rx_flags : uint8_t {
-    good = 0,
-    parity_error = 1,  // Level problem on wire
-    data_overrun = 2,  // ISR was too slow
-    frame_error = 4,   // Clock problem on wire
-    overflow = 8       // RX buffer overflowed (application didn't read soon enough)
-  };
-
-  constexpr static uint8_t uart_buffer_len = 31;  // Effective size for the TRX buffers
+  constexpr static uint8_t uart_buffer_len = 32;  // Effective size for the TRX buffers (2^k)
+  constexpr static uint8_t uart_rx_buffer_len = UART_RX_BUFFER_LEN;
+  constexpr static uint8_t uart_tx_descriptors = 4;  // Pending uart_write() calls (2^k)
   constexpr static uint8_t uart_data_bits = UART_DATA_BITS;
   constexpr static uint8_t uart_parity_bits = UART_PARITY_BITS;
   constexpr static uint8_t uart_stop_bits = UART_STOP_BITS;
   constexpr static uint8_t uart_frame_len = 1 + uart_data_bits + uart_parity_bits + uart_stop_bits;
   constexpr static uint32_t uart_baud_rate = UART_BAUD;
 
-  using uart_rx_status = uint8_t;
+  // The baud rate configuration of the asynchronous mode, fails to compile if UART_BAUD can't be
+  // reached within UART_BAUD_MAX_ERROR_PPM, or UART_BAUD_MAX_ERROR_X2_PPM in double speed mode.
+  using uart_baud_config = uart_baud<F_CPU, uart_baud_rate, UART_BAUD_MAX_ERROR_PPM,
+                                     uart_speed_mode, UART_BAUD_MAX_ERROR_X2_PPM>;
+
   using uart_symbol_period = xtd::ratio<uart_frame_len, uart_baud_rate>;
   using uart_symbol_duration = typename xtd::chrono::duration<int16_t, uart_symbol_period>;
   using uart_rx_callback = void (*)(char, uart_rx_status);
+  using uart_tx_callback = void (*)();
 
   // Enables UART with the following callback on data RX. If null, RX is disabled.
   void uart_configure(uart_rx_callback rx_callback);
@@ -75,16 +88,120 @@ namespace xtd {
   // Blocks until the TX queue is emptied.
   void uart_flush();
 
-  // Puts one character onto the TX queue.
+#if UART_RX_BUFFER_LEN > 0
+  // Enables UART with received bytes stored in the RX buffer by the RX ISR, to be read with
+  // uart_get() or istream<uart_stream_tag>. No callback is made from the ISR.
+  void uart_configure_buffered();
+
+  // Returns the number of bytes in the RX buffer.
+  uint8_t uart_rx_available();
+
+  // Removes and returns the next byte from the RX buffer, or -1 if the buffer is empty.
+  // Must only be called from one context, the main program or a task.
+  int16_t uart_get();
+
+  // Returns the next byte from the RX buffer without removing it, or -1 if the buffer is empty.
+  int16_t uart_peek();
+
+  // Returns the uart_rx_flags of all errors since the last call and clears them.
+  //
+  // uart_rx_flags::overflow is set when a received byte was dropped because the RX buffer was
+  // full, uart_rx_overflow_count() tells how many were dropped.
+  uart_rx_status uart_rx_errors();
+
+  // Returns the number of bytes dropped because the RX buffer was full, saturates at 255. Cleared
+  // by uart_rx_errors().
+  uint8_t uart_rx_overflow_count();
+#endif
+
+  // Puts one character onto the TX queue, blocks while the queue is full. See uart_try_put() for a
+  // non-blocking alternative.
+  //
+  // The TX queue is a lock-free single producer queue that is drained from the UDRE ISR, so this
+  // never disables interrupts. As a consequence all calls to uart_put() must be made from the same
+  // context, do not mix calls from the main program and ISRs.
   void uart_put(char c);
 
+  // Puts one character onto the TX queue if there is room for it, never blocks.
+  // Returns false if the queue was full. Must be called from the same context as uart_put().
+  bool uart_try_put(char c);
+
+  // Copies as many of the `len` bytes from `data` as fit onto the TX queue, never blocks.
+  // Returns the number of bytes accepted. Must be called from the same context as uart_put().
+  uint16_t uart_try_write(const uint8_t* data, uint16_t len);
+
+  // Arms a one-shot notification: `cb` is called from the UDRE ISR as soon as at most `watermark`
+  // bytes remain in the TX queue. Arming a new notification replaces any pending one, a null `cb`
+  // disarms it.
+  //
+  // This lets a producer that got a short count from uart_try_write() yield instead of spinning:
+  //
+  //     void producer_task() {
+  //       sent += xtd::uart_try_write(frame + sent, sizeof(frame) - sent);
+  //       if (sent < sizeof(frame)) {
+  //         xtd::uart_notify_tx_space([]() { scheduler.schedule(producer_task); },
+  //                                   xtd::uart_buffer_len / 2);
+  //       }
+  //     }
+  void uart_notify_tx_space(uart_tx_callback cb, uint8_t watermark);
+
+  // Queues `len` bytes from `data` for transmission without copying them. The UDRE ISR streams the
+  // bytes directly from the buffer, in order with bytes from uart_put() and other writes. Blocks
+  // while uart_tx_descriptors writes are already pending.
+  //
+  // The buffer must not be modified until `done` is called, from the UDRE ISR, after the last
+  // byte has been handed to the hardware. `done` may be null.
+  //
+  // Must be called from the same context as uart_put().
+  void uart_write(const uint8_t* data, uint16_t len, uart_tx_callback done = nullptr);
+
+  // As uart_write() but for a buffer in program memory, e.g. from PSTR().
+  void uart_write_P(PGM_P data, uint16_t len, uart_tx_callback done = nullptr);
+
   struct uart_stream_tag {};
 
   template <>
   class ostream<uart_stream_tag> {
   public:
     void put(char c) { uart_put(c); }
+
+    // Copies the characters onto the TX queue in as few bulk operations as possible, blocks while
+    // the queue is full. See buffered_ostream in "buffered_ostream.hpp".
+    void write(const char* data, uint16_t len) {
+      while (len) {
+        auto n = uart_try_write(reinterpret_cast<const uint8_t*>(data), len);
+        if (n == 0) {
+          uart_put(*data);  // Waits for space
+          n = 1;
+        }
+        data += n;
+        len = uint16_t(len - n);
+      }
+    }
+  };
+
+#if UART_RX_BUFFER_LEN > 0
+  // Reads from the UART RX buffer, see uart_configure_buffered().
+  //
+  // Functions that need more data than is in the buffer wait for it to arrive, they only see
+  // end-of-file if the RX side of the UART is disabled. Receive errors do not affect the stream
+  // state, check uart_rx_errors() for those. Use readsome() from a task to avoid waiting.
+  template <>
+  class istream<uart_stream_tag> : public istream_base<istream<uart_stream_tag>> {
+  public:
+    int_type underflow() {
+      int_type c;
+      while ((c = uart_peek()) == eof() && uart_can_rx()) {
+        // Wait for data
+      }
+      return c;
+    }
+
+    void bump() { uart_get(); }
+
+    size_type available() { return uart_rx_available(); }
   };
+#endif
 }  // namespace xtd
 
 #endif
@@ -1,6 +1,7 @@
 #ifndef XTD_UC_UNIT_IMPL_HPP
 #define XTD_UC_UNIT_IMPL_HPP
 #include "common.hpp"
+#include "ostream.hpp"
 #include "ratio.hpp"
 
 #ifdef HAS_STL
@@ -24,10 +25,10 @@ namespace xtd {
         explicit unit_ratios() = default;
       };
 
-#ifdef HAS_STL
-      template <typename A, typename K, typename s, typename m, typename kg, typename cd,
-                typename mol>
-      std::ostream& operator<<(std::ostream& os, unit_ratios<A, K, s, m, kg, cd, mol>) {
+      // Prints the unit symbols, works with both std::ostream and xtd::ostream.
+      template <typename OStream, typename A, typename K, typename s, typename m, typename kg,
+                typename cd, typename mol>
+      OStream& operator<<(OStream& os, unit_ratios<A, K, s, m, kg, cd, mol>) {
 #define STRINGIFY2(X) #X
 #define STRINGIFY(X) STRINGIFY2(X)
         bool first = true;
@@ -65,15 +66,13 @@ namespace xtd {
         PRINT_SYMBOL_POS(cd, < 0);
         PRINT_SYMBOL_POS(mol, < 0);
 
-#undef PRINT_SYMBOL
+#undef PRINT_SYMBOL_POS
 #undef STRINGIFY2
 #undef STRINGIFY
 
         return os;
       }
 
-#endif
-
       template <typename lhs, typename rhs>
       using unit_ratios_add = unit_ratios<ratio_add<typename lhs::ampere, typename rhs::ampere>,
                                           ratio_add<typename lhs::kelvin, typename rhs::kelvin>,
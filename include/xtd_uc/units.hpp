@@ -107,6 +107,18 @@ namespace xtd {
       value_type v;
     };
 
+    // Prints the quantity in its unscaled unit as a float followed by the unit symbols, e.g.
+    // "0.250000 s" for 250 ms. See xtd::setprecision() to control the number of decimals.
+    template <typename stream_tag, typename V, typename U, typename S>
+    xtd::ostream<stream_tag>& operator<<(xtd::ostream<stream_tag>& os, const quantity<V, U, S>& q) {
+      os << static_cast<float>(xtd::ratio_scale<S>(static_cast<float>(q.count())));
+      if (!is_same<unity, U>::value) {
+        os.put(' ');
+        os << U();
+      }
+      return os;
+    }
+
     template <typename v, typename u, typename s, long long x>
     constexpr auto make_unity_valued() {
       return quantity<v, u, ratio_multiply<s, ratio<x>>>(1);
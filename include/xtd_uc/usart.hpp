@@ -0,0 +1,312 @@
+#ifndef XTD_UC_USART_HPP
+#define XTD_UC_USART_HPP
+#include "common.hpp"
+
+#include "cstdint.hpp"
+#include "power.hpp"
+#include "spsc_queue.hpp"
+#include "utility.hpp"
+
+#ifdef ENABLE_TEST
+#include "fake_avr.hpp"
+#else
+#include <avr/io.h>
+#include <util/atomic.h>
+#endif
+
+// The largest acceptable difference between the requested and the achieved baud rate, in parts per
+// million, in the normal and the double speed (U2Xn) mode. These are the recommended maximum
+// receiver errors from the datasheet for 8N1 frames, 2.0% and 1.5%. The double speed mode samples
+// each bit fewer times, so it tolerates less error.
+#ifndef UART_BAUD_MAX_ERROR_PPM
+#define UART_BAUD_MAX_ERROR_PPM 20000
+#endif
+#ifndef UART_BAUD_MAX_ERROR_X2_PPM
+#define UART_BAUD_MAX_ERROR_X2_PPM 15000
+#endif
+
+namespace xtd {
+
+  enum uart_rx_flags : uint8_t {
+    good = 0,
+    parity_error = 1,  // Level problem on wire
+    data_overrun = 2,  // ISR was too slow
+    frame_error = 4,   // Clock problem on wire
+    overflow = 8       // RX buffer overflowed (application didn't read soon enough)
+  };
+
+  using uart_rx_status = uint8_t;
+
+  // Register access for USART number `instance`. Only the instances the MCU has are defined.
+  template <uint8_t instance>
+  struct usart_hw;
+
+  template <>
+  struct usart_hw<0> {
+    static volatile uint8_t& ucsra() { return UCSR0A; }
+    static volatile uint8_t& ucsrb() { return UCSR0B; }
+    static volatile uint8_t& ucsrc() { return UCSR0C; }
+    static volatile uint16_t& ubrr() { return UBRR0; }
+    static volatile uint8_t& udr() { return UDR0; }
+#ifdef PRR0
+    static volatile uint8_t& prr() { return PRR0; }
+#else
+    static volatile uint8_t& prr() { return PRR; }
+#endif
+    constexpr static uint8_t prr_bit = PRUSART0;
+    constexpr static power_user power = power_user::uart;
+  };
+
+#if defined(UCSR1A) || defined(ENABLE_TEST)  // The fake registers are variables
+  template <>
+  struct usart_hw<1> {
+    static volatile uint8_t& ucsra() { return UCSR1A; }
+    static volatile uint8_t& ucsrb() { return UCSR1B; }
+    static volatile uint8_t& ucsrc() { return UCSR1C; }
+    static volatile uint16_t& ubrr() { return UBRR1; }
+    static volatile uint8_t& udr() { return UDR1; }
+#if defined(__AVR_ATmega640__) || defined(__AVR_ATmega1280__) ||   \
+    defined(__AVR_ATmega1281__) || defined(__AVR_ATmega2560__) || \
+    defined(__AVR_ATmega2561__) || defined(__AVR_ATmega16U4__) || \
+    defined(__AVR_ATmega32U4__)
+    static volatile uint8_t& prr() { return PRR1; }  // These have PRUSART1 in PRR1
+#elif defined(PRR0)
+    static volatile uint8_t& prr() { return PRR0; }  // 164/324/644/1284 and 328PB
+#else
+    static volatile uint8_t& prr() { return PRR; }  // The fake PRR is laid out like PRR0
+#endif
+    constexpr static uint8_t prr_bit = PRUSART1;
+    constexpr static power_user power = power_user::uart1;
+  };
+#endif
+
+  // Selects the normal (16 samples per bit) or double speed (8 samples per bit, U2Xn) mode.
+  enum class uart_speed : uint8_t {
+    automatic,  // The mode with the lowest baud rate error, normal if they are equal
+    normal,
+    x2
+  };
+
+  namespace detail {
+    // The divisor F_CPU / (samples * baud), rounded to nearest. Only valid if in [1, 4096].
+    constexpr uint32_t uart_divisor(uint32_t f_cpu, uint32_t baud, uint32_t samples) {
+      return (f_cpu + samples * baud / 2) / (samples * baud);
+    }
+
+    constexpr bool uart_divisor_valid(uint32_t divisor) { return divisor >= 1 && divisor <= 4096; }
+
+    constexpr int32_t uart_error_ppm(uint32_t f_cpu, uint32_t baud, uint32_t samples,
+                                     uint32_t divisor) {
+      return int32_t((int64_t(f_cpu) * 1000000 / (int64_t(samples) * divisor) -
+                      int64_t(baud) * 1000000) /
+                     int64_t(baud));
+    }
+
+    constexpr uint32_t uart_abs(int32_t x) { return x < 0 ? uint32_t(-x) : uint32_t(x); }
+  }  // namespace detail
+
+  // Compile time baud rate configuration.
+  //
+  // Computes the UBRRn value for both the normal and the double speed mode and, unless `speed_`
+  // forces one of them, picks the one whose achieved baud rate is closest to `baud_`, preferring a
+  // mode whose error is within its limit, `max_error_ppm_` for the normal and `max_error_x2_ppm_`
+  // for the double speed mode. It is a compile time error if the baud rate can't be reached or the
+  // error of the picked mode exceeds its limit.
+  //
+  // Example, 57600 baud at 16 MHz:
+  //     using baud = xtd::uart_baud<16000000, 57600>;
+  //     baud::x2;           // true
+  //     baud::ubrr;         // 34
+  //     baud::actual_baud;  // 57142
+  //     baud::error_ppm;    // -7936, i.e. -0.8% (normal mode would be +2.1%)
+  //
+  // 115200 baud at 16 MHz does not compile with the default limits, it is -3.5% off in the normal
+  // and +2.1% in the double speed mode.
+  template <uint32_t f_cpu_, uint32_t baud_, uint32_t max_error_ppm_ = UART_BAUD_MAX_ERROR_PPM,
+            uart_speed speed_ = uart_speed::automatic,
+            uint32_t max_error_x2_ppm_ = UART_BAUD_MAX_ERROR_X2_PPM>
+  struct uart_baud {
+  private:
+    constexpr static uint32_t normal_div = detail::uart_divisor(f_cpu_, baud_, 16);
+    constexpr static uint32_t x2_div = detail::uart_divisor(f_cpu_, baud_, 8);
+    constexpr static bool normal_ok =
+        speed_ != uart_speed::x2 && detail::uart_divisor_valid(normal_div);
+    constexpr static bool x2_ok =
+        speed_ != uart_speed::normal && detail::uart_divisor_valid(x2_div);
+    constexpr static uint32_t normal_error =
+        detail::uart_abs(detail::uart_error_ppm(f_cpu_, baud_, 16, normal_div));
+    constexpr static uint32_t x2_error =
+        detail::uart_abs(detail::uart_error_ppm(f_cpu_, baud_, 8, x2_div));
+    constexpr static bool normal_fits = normal_ok && normal_error <= max_error_ppm_;
+    constexpr static bool x2_fits = x2_ok && x2_error <= max_error_x2_ppm_;
+
+  public:
+    static_assert(normal_ok || x2_ok, "The baud rate can't be reached with this F_CPU!");
+
+    // True if the double speed mode (U2Xn) is used.
+    constexpr static bool x2 =
+        x2_ok && (!normal_ok || (x2_fits != normal_fits ? x2_fits : x2_error < normal_error));
+    constexpr static uint32_t samples = x2 ? 8 : 16;
+    constexpr static uint16_t ubrr = uint16_t((x2 ? x2_div : normal_div) - 1);
+
+    // The baud rate achieved with ubrr, rounded down.
+    constexpr static uint32_t actual_baud = f_cpu_ / (samples * (ubrr + 1UL));
+
+    // The relative error of the achieved baud rate in parts per million, positive if it's too fast.
+    constexpr static int32_t error_ppm = detail::uart_error_ppm(f_cpu_, baud_, samples, ubrr + 1UL);
+
+    static_assert(x2 ? x2_fits : normal_fits,
+                  "The baud rate error is too large, use another baud rate or F_CPU!");
+  };
+
+  enum class uart_parity : uint8_t { none = 0b00, even = 0b10, odd = 0b11 };
+
+  // The asynchronous frame format: data bits, parity and stop bits.
+  template <uint8_t data_bits_ = 8, uart_parity parity_ = uart_parity::none, uint8_t stop_bits_ = 1>
+  struct uart_frame {
+    static_assert(5 <= data_bits_ && data_bits_ <= 8, "Only 5-8 bit data supported!");
+    static_assert(1 == stop_bits_ || 2 == stop_bits_, "Only 1 or 2 stop bits possible!");
+
+    // The number of bits on the wire per frame.
+    constexpr static uint8_t bits =
+        1 + data_bits_ + (parity_ == uart_parity::none ? 0 : 1) + stop_bits_;
+
+    // The value of the UCSRnC register.
+    constexpr static uint8_t ucsrc = (uint8_t(parity_) << UPM00) | ((stop_bits_ - 1) << USBS0) |
+                                     ((data_bits_ - 5) << UCSZ00);
+  };
+
+  // An interrupt driven asynchronous USART with its own TX and RX buffers.
+  //
+  // Unlike the uart_* functions in "uart.hpp", which drive USART0 with settings from macros, any
+  // number of USARTs can be used with individual settings:
+  //
+  //     xtd::uart<0, 500000, xtd::uart_frame<>, 128, 128> link;
+  //     xtd::uart<1, 9600, xtd::uart_frame<>, 8, 2> debug;
+  //
+  //     ISR(USART0_UDRE_vect) { link.on_udre(); }
+  //     ISR(USART0_RX_vect) { link.on_rx(); }
+  //     ISR(USART1_UDRE_vect) { debug.on_udre(); }
+  //     ISR(USART1_RX_vect) { debug.on_rx(); }
+  //
+  // The ISRs are defined by the application as their names differ between devices. Do not build
+  // "uart.cpp" if it would define the ISRs of the same USART.
+  //
+  // The UBRR value and the speed mode are computed at compile time from F_CPU and `baud_`, see
+  // uart_baud. The buffer lengths must be
+  // powers of two up to 128. The buffers are lock-free single producer/single consumer queues, so
+  // the TX functions must all be called from one context, and the RX functions from one context.
+  template <uint8_t instance_, uint32_t baud_, typename frame_ = uart_frame<>,
+            fast_size_t tx_buffer_len_ = 32, fast_size_t rx_buffer_len_ = 32>
+  class uart {
+  public:
+    using hw = usart_hw<instance_>;
+    using frame = frame_;
+    using size_type = fast_size_t;
+
+    using baud = uart_baud<F_CPU, baud_>;
+
+    // Powers up the USART and enables transmission and reception.
+    void configure() {
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        clr_bit(hw::prr(), hw::prr_bit);
+        hw::ubrr() = baud::ubrr;
+        hw::ucsra() = baud::x2 ? _BV(U2X0) : 0;
+        hw::ucsrc() = frame::ucsrc;
+        hw::ucsrb() = _BV(RXEN0) | _BV(RXCIE0) | _BV(TXEN0);
+        power_set_active(hw::power, true);
+      }
+    }
+
+    // Disables the USART and removes power from it. Pending TX data is discarded.
+    void disable() {
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        hw::ucsrb() = 0;
+        set_bit(hw::prr(), hw::prr_bit);
+        m_tx.clear();
+        power_set_active(hw::power, false);
+      }
+    }
+
+    // Puts one character onto the TX queue, waits while the queue is full.
+    void put(char c) {
+      while (!try_put(c)) {
+        // Wait for the UDRE ISR to make room
+      }
+    }
+
+    // Puts one character onto the TX queue if there is room for it, never blocks.
+    // Returns false if the queue was full.
+    bool try_put(char c) {
+      if (!m_tx.try_push(uint8_t(c))) {
+        return false;
+      }
+      set_bit(hw::ucsrb(), UDRIE0);
+      return true;
+    }
+
+    // Copies as many of the `len` bytes from `data` as fit onto the TX queue, never blocks.
+    // Returns the number of bytes accepted.
+    size_type try_write(const uint8_t* data, size_type len) {
+      const auto n = m_tx.push_n(data, len);
+      if (n > 0) {
+        set_bit(hw::ucsrb(), UDRIE0);
+      }
+      return n;
+    }
+
+    // Waits until the TX queue is empty.
+    void flush() const {
+      while (test_bit(hw::ucsrb(), UDRIE0)) {
+        // Wait for the UDRE ISR to drain the queue
+      }
+    }
+
+    // Returns the number of bytes in the RX buffer.
+    size_type rx_available() const { return m_rx.size(); }
+
+    // Removes and returns the next received byte, or -1 if there is none.
+    int16_t get() { return m_rx.empty() ? -1 : m_rx.get(); }
+
+    // Returns the next received byte without removing it, or -1 if there is none.
+    int16_t peek() { return m_rx.empty() ? -1 : m_rx.peek(); }
+
+    // Returns the uart_rx_flags of all errors since the last call and clears them.
+    uart_rx_status rx_errors() {
+      uart_rx_status ans;
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        ans = m_rx_errors;
+        m_rx_errors = 0;
+      }
+      return ans;
+    }
+
+    // Must be called from the USARTn_UDRE ISR.
+    void on_udre() {
+      if (!m_tx.empty()) {
+        hw::udr() = m_tx.get();
+      } else {
+        clr_bit(hw::ucsrb(), UDRIE0);  // No more data, disable interrupts on empty data register.
+      }
+    }
+
+    // Must be called from the USARTn_RX ISR.
+    void on_rx() {
+      uart_rx_status status = (hw::ucsra() >> UPE0) & 0x7;
+      const uint8_t data = hw::udr();  // Must always be read, otherwise IRQ will not be cleared.
+      if (!m_rx.try_push(data)) {
+        status |= uart_rx_flags::overflow;
+      }
+      if (status) {
+        m_rx_errors = m_rx_errors | status;
+      }
+    }
+
+  private:
+    spsc_queue<uint8_t, tx_buffer_len_> m_tx;
+    spsc_queue<uint8_t, rx_buffer_len_> m_rx;
+    volatile uart_rx_status m_rx_errors = 0;
+  };
+}  // namespace xtd
+
+#endif
@@ -2,12 +2,12 @@
 
 #include <avr/interrupt.h>
 #include <avr/io.h>
-#include <avr/sleep.h>
 #include <stdint.h>
 #include <util/atomic.h>
 
 #include "xtd_uc/common.hpp"
 #include "xtd_uc/delay.hpp"
+#include "xtd_uc/power.hpp"
 #include "xtd_uc/utility.hpp"
 
 static volatile xtd::adc_callback_t g_conversion_complete_cb = nullptr;
@@ -41,6 +41,7 @@ namespace xtd {
              _BV(ADIE) |                           // Enable IRQ on conversion complete.
              _BV(ADIF) |                           // Clear IRQ flag
              adc_prescaler_bits(F_CPU, adc_hz.count());
+    power_set_active(power_user::adc, true);
   }
 
   bool adc_is_enabled() { return !test_bit(PRR, PRADC) && test_bit(ADCSRA, ADEN); }
@@ -50,6 +51,7 @@ namespace xtd {
       set_bit(ADCSRA, ADIF);  // Clear pending irq flag
       clr_bit(ADCSRA, ADEN);  // Disable ADC
       set_bit(PRR, PRADC);    // Take ADC power in Power Reduction Register
+      power_set_active(power_user::adc, false);
     }
   }
 
@@ -74,8 +76,11 @@ namespace xtd {
   }
 
   void adc_continuous_stop() {
-    clr_bit(ADCSRA, ADEN);  // Disable ADC
-    g_conversion_complete_cb = nullptr;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+      clr_bit(ADCSRA, ADEN);  // Disable ADC
+      g_conversion_complete_cb = nullptr;
+      power_set_active(power_user::adc, false);
+    }
   }
 
   void adc_dio_pin(uint8_t channel, bool enabled) { xtd::force_bit(DIDR0, channel, enabled); }
@@ -98,16 +103,11 @@ namespace xtd {
     ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
       ADCSRA |= _BV(ADSC);  // Start Conversion
 
-      // Busy wait until the conversion is done.
-      // At most 25*128 = 3200 cycles
-      sleep_enable();
-      set_sleep_mode(SLEEP_MODE_ADC);
+      // Sleep until the conversion is done, at most 25*128 = 3200 cycles. The power manager
+      // never picks this mode itself as it would start conversions nobody asked for.
       while (test_bit(ADCSRA, ADSC)) {
-        sei();
-        sleep_cpu();
-        cli();
+        power_sleep(sleep_mode::adc);
       }
-      sleep_disable();
       l = ADCL;
       h = ADCH;
     }
@@ -1,12 +1,16 @@
 #include "xtd_uc/common.hpp"
 
 #include "xtd_uc/chrono.hpp"
+#include "xtd_uc/power.hpp"
 #include "xtd_uc/utility.hpp"
 
 #include <util/atomic.h>
 
 ISR(TIMER2_OVF_vect) { xtd::chrono::steady_clock::ticks += 256; }
 
+// One-shot, waking the MCU up from sleep is all that this interrupt is for.
+ISR(TIMER2_COMPA_vect) { xtd::clr_bit(TIMSK2, OCIE2A); }
+
 namespace xtd {
   namespace chrono {
 
@@ -25,6 +29,9 @@ namespace xtd {
         TCCR2B = 0b111 << CS20;  // Prescale clock frequency by 1/1024
         TIMSK2 = _BV(TOIE2);     // Overflow interrupt enable for timer 2
       }
+      // Time is lost if TIMER2 stops. Clocked from the I/O clock as above it only runs in Idle,
+      // the power manager checks ASSR.AS2 to allow Power-save with an asynchronous crystal.
+      power_set_active(power_user::chrono, true);
     }
 
     steady_clock::time_point steady_clock::now() {
@@ -35,5 +42,26 @@ namespace xtd {
       *reinterpret_cast<volatile uint8_t*>(&ans) = TCNT2;
       return time_point(duration(ans));
     }
+
+    bool steady_clock::wake_at(const time_point& t) {
+      constexpr auto period_mask = ~value_type(0xFF);
+      const auto target = t.time_since_epoch().count();
+      const auto current = now().time_since_epoch().count();
+
+      if (target <= current || (target & period_mask) != (current & period_mask)) {
+        return false;
+      }
+
+      OCR2A = static_cast<uint8_t>(target);
+      if (ASSR & _BV(AS2)) {
+        // The write reaches the asynchronous clock domain within a couple of TOSC1 cycles, the
+        // match is lost if the MCU enters Power-save before that.
+        while (ASSR & _BV(OCR2AUB)) {
+        }
+      }
+      TIFR2 = _BV(OCF2A);  // Clear any stale compare match
+      xtd::set_bit(TIMSK2, OCIE2A);
+      return true;
+    }
   }  // namespace chrono
 }  // namespace xtd
@@ -1,7 +1,6 @@
 #include "xtd_uc/i2c.hpp"
 
-#include "xtd_uc/algorithm.hpp"
-#include "xtd_uc/cmath.hpp"
+#include "xtd_uc/power.hpp"
 #include "xtd_uc/utility.hpp"
 
 #include <avr/io.h>
@@ -155,7 +154,7 @@ namespace xtd {
       case twi_sr_addressed_lost_arb:  // FALLTHROUGH
       case twi_gc_addressed:           // FALLTHROUGH
       case twi_gc_addressed_lost_arb:
-        return release_scl(i2c_busy);
+        return release_scl(i2c_slave_addressed);
 
       case twi_sr_data_ack_returned:  // FALLTHROUGH
       case twi_gc_data_ack_returned:
@@ -169,10 +168,11 @@ namespace xtd {
 
       case twi_sr_data_nack_returned:  // FALLTHROUGH
       case twi_gc_data_nack_returned:
-        return release_scl(i2c_busy);
+        // Switched to the not addressed slave mode, no STOP will be reported
+        return release_scl(i2c_idle);
 
       case twi_stop_cond_received:
-        return release_scl(i2c_busy);
+        return release_scl(i2c_slave_stop);
 
         // Slave Transmitter
       case twi_st_addressed:           // FALLTHROUGH
@@ -184,7 +184,8 @@ namespace xtd {
 
       case twi_st_data_nack_received:  // FALLTHROUGH
       case twi_st_last_data_ack_received:
-        return release_scl(i2c_busy);
+        // Switched to the not addressed slave mode, no STOP will be reported
+        return release_scl(i2c_idle);
     };
 
     return i2c_internal_error;
@@ -193,12 +194,13 @@ namespace xtd {
   void i2c_device::power_on() {
     ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
       clr_bit(PRR, PRTWI);  // Power up the IO
+      power_set_active(power_user::i2c, true);
 
       TWCR = _BV(TWINT) |  // Clear any pending IRQ
              _BV(TWEN) |   // Enable TWI (SDA/SCL pins controlled by TWI HW)
              _BV(TWIE);    // Enable IRQs
     }
-    master_speed(100000);  // Standard Speed
+    master_speed<100000>();  // Standard Speed
 
     TWCR = _BV(TWEN) | _BV(TWIE);  // Master mode only enabled initially.
   }
@@ -207,6 +209,7 @@ namespace xtd {
     // TODO: Wait until ongoing transactions finish and transmit stop condition
     TWCR &= ~_BV(TWEN);
     PRR |= _BV(PRTWI);
+    power_set_active(power_user::i2c, false);
   }
 
   void i2c_device::slave_on(i2c_address addr, bool respond_to_gca) {
@@ -220,36 +223,17 @@ namespace xtd {
 
   bool i2c_device::idle() const { return false; }
 
-  uint32_t master_speed(uint32_t bitrate) {
-    // bitrate = CPU_FREQ/(16 + 2 * TWBR * Prescaler)
-    // TWBR * Prescaler = (CPU_FREQ / (bitrate) - 16)/2
-    // TWBR * Prescaler = (CPU_FREQ / (2*bitrate) - 8)
-    // OR: bitrate * TWBR * Prescaler = CPU_FREQ/2 - 8*bitrate
-
-    // Try all prescaler values
-    if (bitrate * 16 > F_CPU) {
-      bitrate = F_CPU / 16;
-    }
-
-    uint32_t best_error = 0xFFFFFFFF;
-    uint8_t best_twbr = 1;
-    uint8_t best_prescaler = 1;
-    for (uint8_t pb = 1; pb < 4; pb++) {
-      auto p = (1 << (2 * pb));
-      auto twbr = divide<uint32_t, round_style::nearest>(F_CPU - 16 * bitrate, 2 * p * bitrate);
-      clamp<decltype(twbr)>(twbr, 0, 255);
-      auto br = F_CPU / (16 + 2 * twbr * p);
-      auto abs_error = br < bitrate ? bitrate - br : br - bitrate;
-      if (abs_error < best_error) {
-        best_error = abs_error;
-        best_prescaler = pb;
-        best_twbr = twbr;
-      }
+  uint32_t i2c_device::master_speed(uint32_t bitrate) {
+    const auto setting = i2c_twi_solve(F_CPU, bitrate);
+    if (setting.rate) {
+      set_bitrate(setting.twbr, setting.twps);
     }
+    return setting.rate;
+  }
 
-    TWBR = best_twbr;
-    TWSR = best_prescaler;
-    return F_CPU / (16 + 2 * best_twbr * best_prescaler);
+  void i2c_device::set_bitrate(uint8_t twbr, uint8_t twps) {
+    TWBR = twbr;
+    TWSR = twps;  // The status bits are read only
   }
 
   void i2c_device::master_txn(i2c_address addr, i2c_txn_mode direction) {
@@ -4,7 +4,8 @@
 
 #include "xtd_uc/delay.hpp"
 #include "xtd_uc/gpio2.hpp"
-#include "xtd_uc/queue.hpp"
+#include "xtd_uc/power.hpp"
+#include "xtd_uc/spsc_queue.hpp"
 #include "xtd_uc/utility.hpp"
 
 #include <avr/io.h>
@@ -25,39 +26,121 @@
 using namespace xtd::unit_literals;
 
 namespace xtd {
-  static queue<uint8_t, uart_buffer_len> tx_queue;
+  // Produced by uart_put() and consumed by the UDRE ISR, neither side needs to disable interrupts.
+  static spsc_queue<uint8_t, uart_buffer_len> tx_queue;
+
+  // A buffer handed over by uart_write() or uart_write_P() that the UDRE ISR streams from.
+  struct tx_descriptor {
+    const uint8_t* data;
+    uint16_t len;
+    bool progmem;
+    uint8_t at;  // The value of tx_put_count when the descriptor was queued
+    uart_tx_callback done;
+  };
+
+  // Produced by uart_write() and consumed by the UDRE ISR, like tx_queue. A descriptor is started
+  // once all bytes that were put onto tx_queue before it have been sent, which is when tx_sent
+  // reaches tx_descriptor::at. Both counters are free running and wrap around, this works as
+  // there are never more than uart_buffer_len bytes between them.
+  static spsc_queue<tx_descriptor, uart_tx_descriptors> tx_descs;
+  static uint8_t tx_put_count;  // Only touched by the producer
+  static uint8_t tx_sent;       // Only touched by the UDRE ISR
+
+  // One-shot notification from the UDRE ISR when tx_queue has drained to the watermark.
+  static uart_tx_callback tx_space_callback;
+  static uint8_t tx_space_watermark;
+
   static uart_rx_callback rx_callback;
 
+#if UART_RX_BUFFER_LEN > 0
+  // Produced by the RX ISR and consumed by uart_get(), used when there is no rx_callback.
+  static spsc_queue<uint8_t, uart_rx_buffer_len> rx_queue;
+  static volatile uart_rx_status rx_errors;
+  static volatile uint8_t rx_overflows;
+#endif
+
 #ifdef TX_LED_ENABLED
   using c_pin_tx_led = pin<UART_TX_LED_PORT, UART_TX_LED_PIN>;
 #endif
+
+  static void tx_descriptor_done(uart_tx_callback& done) {
+    done = tx_descs.peek().done;
+    tx_descs.pop();
+  }
+
+  // Called from the UDRE ISR, fetches the next byte to send in the order it was queued. If the
+  // byte completes a descriptor, `done` is set to its callback.
+  static bool tx_next_byte(uint8_t& byte, uart_tx_callback& done) {
+    while (!tx_descs.empty() && tx_descs.peek().at == tx_sent) {
+      auto& d = tx_descs.peek();
+      if (d.len > 0) {
+        byte = d.progmem ? pgm_read_byte(d.data) : *d.data;
+        d.data++;
+        if (--d.len == 0) {
+          tx_descriptor_done(done);
+        }
+        return true;
+      }
+      tx_descriptor_done(done);  // Nothing to send
+      if (done) {
+        done();
+      }
+    }
+    done = nullptr;
+    if (tx_queue.empty()) {
+      return false;
+    }
+    byte = tx_queue.get();
+    tx_sent++;
+    return true;
+  }
 }  // namespace xtd
 
 ISR(USART_UDRE_vect) {
-  if (!xtd::tx_queue.empty()) {
-    UDR0 = xtd::tx_queue.peek();
+  uint8_t byte;
+  xtd::uart_tx_callback done = nullptr;
+  if (xtd::tx_next_byte(byte, done)) {
+    UDR0 = byte;
 #ifdef TX_LED_ENABLED
     xtd::gpio_write(xtd::c_pin_tx_led, UART_TX_LED_ACTIVE);
 #endif
-    xtd::tx_queue.pop();
   } else {
     xtd::clr_bit(UCSR0B, UDRIE0);  // No more data, disable interrupts on empty data register.
 #ifdef TX_LED_ENABLED
     xtd::gpio_write(xtd::c_pin_tx_led, !UART_TX_LED_ACTIVE);
 #endif
   }
+  if (done) {
+    done();  // Called after the last byte has been handed to the hardware
+  }
+  if (xtd::tx_space_callback && xtd::tx_queue.size() <= xtd::tx_space_watermark) {
+    const auto cb = xtd::tx_space_callback;
+    xtd::tx_space_callback = nullptr;
+    cb();
+  }
 }
 
 ISR(USART_RX_vect) {
   xtd::uart_rx_status status = (UCSR0A >> UPE0) & 0x7;
   uint8_t data = UDR0;  // Data must always be read, otherwise IRQ will not be cleared.
+#if UART_RX_BUFFER_LEN > 0
+  if (!xtd::rx_callback) {
+    if (!xtd::rx_queue.try_push(data)) {
+      status |= xtd::uart_rx_flags::overflow;
+      if (xtd::rx_overflows != 0xFF) {
+        xtd::rx_overflows = xtd::rx_overflows + 1;
+      }
+    }
+    xtd::rx_errors = xtd::rx_errors | status;
+    return;
+  }
+#endif
   xtd::rx_callback(data, status);
 }
 
 namespace xtd {
 
-  void uart_configure(uart_rx_callback rx_cb) {
-    rx_callback = rx_cb;
+  static void configure(bool rx_enable) {
 
 #ifdef TX_LED_ENABLED
     xtd::gpio_config(xtd::c_pin_tx_led, xtd::gpio_mode::output, !UART_TX_LED_ACTIVE);
@@ -67,17 +150,22 @@ namespace xtd {
     // interrupt processing. Further more when we're done we want global interrupts to remain on
     // as this is an interrupt based UART driver.
     ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+#if UART_SYNC
       // See table 20-1 in Atmega 328P datasheet
       using mcuratio = ratio<F_CPU, uart_baud_rate>;
-      using x2ratio = ratio<(UART_SYNC ? 2 : (UART_X2 ? 8 : 16))>;
       constexpr uint16_t ubrr =
-          ratio_subtract<ratio_divide<mcuratio, x2ratio>, ratio<1>>::value_round;
+          ratio_subtract<ratio_divide<mcuratio, ratio<2>>, ratio<1>>::value_round;
+      constexpr bool x2 = false;
+#else
+      constexpr uint16_t ubrr = uart_baud_config::ubrr;
+      constexpr bool x2 = uart_baud_config::x2;
+#endif
 
       // Enable power to the UART
-      auto rx_en_mask = rx_cb != nullptr ? _BV(RXEN0) | _BV(RXCIE0) : 0;
+      auto rx_en_mask = rx_enable ? _BV(RXEN0) | _BV(RXCIE0) : 0;
       clr_bit(PRR, PRUSART0);
       UBRR0 = ubrr;
-      UCSR0A = UART_X2 ? _BV(U2X0) : uint8_t();
+      UCSR0A = x2 ? _BV(U2X0) : uint8_t();
       UCSR0B = rx_en_mask | _BV(TXEN0);
 
       constexpr auto paritybit_mask =
@@ -87,20 +175,57 @@ namespace xtd {
 
       UCSR0C = (paritybit_mask << UPM00) | (stopbit_mask << USBS0) | (databit_mask << UCSZ00) |
                ((UART_SYNC ? 1 : 0) << UMSEL00);
+      power_set_active(power_user::uart, true);
     }
   }
 
+  void uart_configure(uart_rx_callback rx_cb) {
+    rx_callback = rx_cb;
+    configure(rx_cb != nullptr);
+  }
+
+#if UART_RX_BUFFER_LEN > 0
+  void uart_configure_buffered() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+      rx_callback = nullptr;
+      rx_queue.clear();
+      rx_errors = 0;
+      rx_overflows = 0;
+    }
+    configure(true);
+  }
+
+  uint8_t uart_rx_available() { return rx_queue.size(); }
+
+  int16_t uart_get() { return rx_queue.empty() ? -1 : rx_queue.get(); }
+
+  int16_t uart_peek() { return rx_queue.empty() ? -1 : rx_queue.peek(); }
+
+  uart_rx_status uart_rx_errors() {
+    uart_rx_status ans;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+      ans = rx_errors;
+      rx_errors = 0;
+      rx_overflows = 0;
+    }
+    return ans;
+  }
+
+  uint8_t uart_rx_overflow_count() { return rx_overflows; }
+#endif
+
   void uart_disable() {
     ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
       UCSR0A = 0;
       UCSR0B = 0;
       UCSR0C = 0;
       PRR |= _BV(PRUSART0);  // Kill power to UART
+      power_set_active(power_user::uart, false);
     }
   }
 
-  bool uart_can_rx() { return !(PRR & _BV(PRUSART0)) && (UCSR0B & _BV(TXEN0)); }
-  bool uart_can_tx() { return !(PRR & _BV(PRUSART0)) && UCSR0B & _BV(RXEN0); }
+  bool uart_can_rx() { return !(PRR & _BV(PRUSART0)) && (UCSR0B & _BV(RXEN0)); }
+  bool uart_can_tx() { return !(PRR & _BV(PRUSART0)) && (UCSR0B & _BV(TXEN0)); }
 
   void uart_flush() {
     NONATOMIC_BLOCK(NONATOMIC_RESTORESTATE) {
@@ -111,20 +236,61 @@ namespace xtd {
   }
 
   void uart_put(char data) {
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
-      while (tx_queue.full()) {
-        // The buffer is full, sleep the expected time required to empty a quarter of it.
-        // We don't want to busy poll as that constant disabling of interrupts would
-        // mess with the transmitter.
-
-        sei();
-        delay(uart_symbol_duration(uart_buffer_len / 4));
-        cli();
-      }
-      tx_queue.push(data);
+    while (tx_queue.full()) {
+      // The buffer is full, sleep the expected time required to empty a quarter of it.
+      delay(uart_symbol_duration(uart_buffer_len / 4));
+    }
+    tx_queue.push(data);
+    tx_put_count++;
+
+    // Enable interrupt processing if it was disabled. The UDRE ISR only ever clears this bit when
+    // the queue is empty, so if it runs in the middle of this read-modify-write the bit still ends
+    // up set, which is what we want as there is data to send.
+    xtd::set_bit(UCSR0B, UDRIE0);
+  }
 
-      // Enable interrupt processing if it was disabled.
+  bool uart_try_put(char data) {
+    if (!tx_queue.try_push(data)) {
+      return false;
+    }
+    tx_put_count++;
+    xtd::set_bit(UCSR0B, UDRIE0);  // See uart_put()
+    return true;
+  }
+
+  uint16_t uart_try_write(const uint8_t* data, uint16_t len) {
+    const auto n =
+        tx_queue.push_n(data, len < uart_buffer_len ? uint8_t(len) : uint8_t(uart_buffer_len));
+    if (n > 0) {
+      tx_put_count = uint8_t(tx_put_count + n);
+      xtd::set_bit(UCSR0B, UDRIE0);  // See uart_put()
+    }
+    return n;
+  }
+
+  void uart_notify_tx_space(uart_tx_callback cb, uint8_t watermark) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+      tx_space_watermark = watermark;
+      tx_space_callback = cb;
+      // Let the UDRE ISR check the watermark, it disables itself again if there is nothing to send.
       xtd::set_bit(UCSR0B, UDRIE0);
     }
   }
+
+  static void write(const uint8_t* data, uint16_t len, bool progmem, uart_tx_callback done) {
+    while (tx_descs.full()) {
+      // Wait for the ISR to finish the oldest descriptor, it takes at least a symbol.
+      delay(uart_symbol_duration(1));
+    }
+    tx_descs.push(tx_descriptor{data, len, progmem, tx_put_count, done});
+    xtd::set_bit(UCSR0B, UDRIE0);  // See uart_put()
+  }
+
+  void uart_write(const uint8_t* data, uint16_t len, uart_tx_callback done) {
+    write(data, len, false, done);
+  }
+
+  void uart_write_P(PGM_P data, uint16_t len, uart_tx_callback done) {
+    write(reinterpret_cast<const uint8_t*>(data), len, true, done);
+  }
 }  // namespace xtd
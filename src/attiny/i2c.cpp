@@ -27,8 +27,10 @@ namespace xtd {
   i2c_device::i2c_device() {}
   i2c_device::~i2c_device() {}
 
-  void i2c_device::on_usi_start() {
+  i2c_state i2c_device::on_usi_start() {
     m_tx_done = false;
+    const bool rx_done = m_rx_active;
+    m_rx_active = false;
 
     // Wait for SCL to go low to ensure the "Start Condition" has completed.
     while ((PINB & _BV(PB2)) & !(USISR & (1 << USIPF)))
@@ -41,6 +43,18 @@ namespace xtd {
 
     read_bits(8, state_addr_rx);
     USISR |= _BV(USISIF);
+    return rx_done ? i2c_slave_stop : i2c_busy;
+  }
+
+  i2c_state i2c_device::poll_stop() {
+    // USIPF is cleared each time a byte is expected, so it is only set if the bus has been
+    // stopped since. The bus is then idle and the counter still, writing it back is safe.
+    if (!m_rx_active || !(USISR & _BV(USIPF))) {
+      return i2c_busy;
+    }
+    m_rx_active = false;
+    USISR = _BV(USIPF) | (USISR & 0x0F);  // Clear only the stop flag
+    return i2c_slave_stop;
   }
 
   i2c_state i2c_device::on_usi_ovf() {
@@ -53,7 +67,8 @@ namespace xtd {
         if (is_for_us(addr)) {
           bool slave_tx = addr & 1;
           write_bits(0x00, 1, slave_tx ? state_tx_wait : state_rx_ackd);
-          return i2c_busy;
+          m_rx_active = !slave_tx;
+          return slave_tx ? i2c_busy : i2c_slave_addressed;
         } else {
           await_start();
           return i2c_idle;
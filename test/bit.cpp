@@ -0,0 +1,28 @@
+#include "xtd_uc/bit.hpp"
+#include <gtest/gtest.h>
+
+TEST(Bit, CountrZeroBits) {
+  for (int i = 1; i < 8; ++i) {
+    ASSERT_EQ(__builtin_ctz(i), xtd::countr_zero_bits<3>(i));
+  }
+  ASSERT_EQ(3, xtd::countr_zero_bits<3>(0));
+}
+
+TEST(Bit, CountrZero8) {
+  for (int i = 1; i < 256; ++i) {
+    ASSERT_EQ(__builtin_ctz(i), xtd::countr_zero(uint8_t(i)));
+  }
+  ASSERT_EQ(8, xtd::countr_zero(uint8_t(0)));
+}
+
+TEST(Bit, CountrZeroWide) {
+  for (int i = 0; i < 16; ++i) {
+    ASSERT_EQ(i, xtd::countr_zero(uint16_t(1u << i)));
+    ASSERT_EQ(i, xtd::countr_zero(uint16_t(0xFFFFu << i)));
+  }
+  for (int i = 0; i < 32; ++i) {
+    ASSERT_EQ(i, xtd::countr_zero(uint32_t(1ul << i)));
+  }
+  ASSERT_EQ(16, xtd::countr_zero(uint16_t(0)));
+  ASSERT_EQ(32, xtd::countr_zero(uint32_t(0)));
+}
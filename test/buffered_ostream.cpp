@@ -0,0 +1,57 @@
+#include "xtd_uc/buffered_ostream.hpp"
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+struct bulk_tag {};
+struct put_only_tag {};
+
+namespace xtd {
+  template <>
+  class ostream<bulk_tag> {
+  public:
+    void put(char c) { writes.push_back(std::string(1, c)); }
+    void write(const char* data, uint16_t len) { writes.push_back(std::string(data, len)); }
+
+    std::vector<std::string> writes;
+  };
+
+  template <>
+  class ostream<put_only_tag> {
+  public:
+    void put(char c) { str.push_back(c); }
+
+    std::string str;
+  };
+}  // namespace xtd
+
+TEST(BufferedOStream, BatchesWrites) {
+  xtd::ostream<bulk_tag> os;
+  {
+    xtd::buffered_ostream<bulk_tag, 8> cut(os);
+    cut << "adc: " << 1234 << "\n" << "0123456789" << "tail";
+    ASSERT_EQ((std::vector<std::string>{"adc: 123", "4\n", "01234567"}), os.writes);
+  }
+  ASSERT_EQ((std::vector<std::string>{"adc: 123", "4\n", "01234567", "89tail"}), os.writes);
+}
+
+TEST(BufferedOStream, Flush) {
+  xtd::ostream<bulk_tag> os;
+  xtd::buffered_ostream<bulk_tag> cut(os);
+  cut << xtd::setprecision(1) << 2.5f;
+  ASSERT_TRUE(os.writes.empty());
+  cut.flush();
+  cut.flush();
+  ASSERT_EQ((std::vector<std::string>{"2.5"}), os.writes);
+  ASSERT_EQ(1, xtd::detail::ostream_state<bulk_tag>::precision);
+}
+
+TEST(BufferedOStream, PutFallback) {
+  xtd::ostream<put_only_tag> os;
+  {
+    xtd::buffered_ostream<put_only_tag, 4> cut(os);
+    cut << "hello" << -7;
+  }
+  ASSERT_EQ("hello-7", os.str);
+}
@@ -0,0 +1,176 @@
+#include "xtd_uc/coroutine.hpp"
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace xtd::unit_literals;
+using duration = xtd::chrono::steady_clock::duration;
+
+struct fake_scheduler {
+  using task_type = void (*)(void);
+
+  bool schedule(task_type t) {
+    ready.push_back(t);
+    return true;
+  }
+
+  bool schedule_after(const duration& d, task_type t) {
+    sleeps.push_back(d);
+    ready.push_back(t);
+    return true;
+  }
+
+  void run_one() {
+    auto t = ready.front();
+    ready.erase(ready.begin());
+    t();
+  }
+
+  // Runs tasks until there are none left, returns the number of tasks run.
+  int run() {
+    int n = 0;
+    while (!ready.empty()) {
+      auto t = ready.front();
+      ready.erase(ready.begin());
+      t();
+      ++n;
+    }
+    return n;
+  }
+
+  std::vector<task_type> ready;
+  std::vector<duration> sleeps;
+};
+
+fake_scheduler g_scheduler;
+static std::vector<int> g_trace;
+static bool g_event = false;
+static xtd::coroutine g_co;
+
+xtd::co_result protocol() {
+  static int i;
+  XTD_CO_BEGIN(g_co);
+  g_trace.push_back(1);
+  XTD_CO_YIELD(g_co);
+  g_trace.push_back(2);
+  XTD_CO_AWAIT(g_co, g_event);
+  g_trace.push_back(3);
+  for (i = 0; i < 2; ++i) {
+    XTD_CO_SLEEP_FOR(g_co, 10_ms);
+    g_trace.push_back(4 + i);
+  }
+  XTD_CO_END(g_co);
+}
+
+using protocol_task = xtd::co_task<fake_scheduler, g_scheduler, protocol>;
+
+TEST(Coroutine, Sizeof) { static_assert(sizeof(xtd::coroutine) == 2, "Coroutine state too big"); }
+
+TEST(Coroutine, SuspendAndResume) {
+  g_co.reset();
+  g_trace.clear();
+  g_event = false;
+
+  ASSERT_TRUE(protocol_task::wake());
+  ASSERT_EQ(2, g_scheduler.run());  // Start + resume after yield, then await the event
+  ASSERT_EQ((std::vector<int>{1, 2}), g_trace);
+  ASSERT_FALSE(g_co.done());
+
+  // Spurious wake up, the condition is still false.
+  protocol_task::wake();
+  ASSERT_EQ(1, g_scheduler.run());
+  ASSERT_EQ((std::vector<int>{1, 2}), g_trace);
+
+  g_event = true;
+  protocol_task::wake();
+  ASSERT_EQ(3, g_scheduler.run());  // Event, and the two sleeps
+  ASSERT_EQ((std::vector<int>{1, 2, 3, 4, 5}), g_trace);
+  ASSERT_EQ(2u, g_scheduler.sleeps.size());
+  ASSERT_EQ(duration(10_ms), g_scheduler.sleeps[0]);
+  ASSERT_TRUE(g_co.done());
+
+  // Finished coroutines stay finished.
+  protocol_task::wake();
+  ASSERT_EQ(1, g_scheduler.run());
+  ASSERT_EQ(5u, g_trace.size());
+}
+
+static xtd::coroutine g_sleeper_co;
+
+xtd::co_result sleeper() {
+  XTD_CO_BEGIN(g_sleeper_co);
+  g_trace.push_back(1);
+  XTD_CO_SLEEP_FOR(g_sleeper_co, 10_ms);
+  g_trace.push_back(2);
+  XTD_CO_YIELD(g_sleeper_co);
+  g_trace.push_back(3);
+  XTD_CO_END(g_sleeper_co);
+}
+
+using sleeper_task = xtd::co_task<fake_scheduler, g_scheduler, sleeper>;
+
+TEST(Coroutine, WakeWhileSleepingOrYielded) {
+  g_sleeper_co.reset();
+  g_trace.clear();
+  g_scheduler.sleeps.clear();
+
+  ASSERT_TRUE(sleeper_task::wake());
+  g_scheduler.run_one();
+  ASSERT_EQ(1u, g_scheduler.sleeps.size());
+  ASSERT_EQ(1u, g_scheduler.ready.size());  // The timer
+
+  // The sleep isn't cut short.
+  ASSERT_TRUE(sleeper_task::wake());
+  ASSERT_EQ(1u, g_scheduler.ready.size());
+
+  g_scheduler.run_one();
+  ASSERT_EQ((std::vector<int>{1, 2}), g_trace);
+  ASSERT_TRUE(sleeper_task::wake());
+  ASSERT_EQ(1u, g_scheduler.ready.size());
+
+  ASSERT_EQ(1, g_scheduler.run());
+  ASSERT_EQ((std::vector<int>{1, 2, 3}), g_trace);
+}
+
+TEST(Coroutine, DoubleWake) {
+  g_sleeper_co.reset();
+  g_trace.clear();
+
+  ASSERT_TRUE(sleeper_task::wake());
+  ASSERT_TRUE(sleeper_task::wake());
+  ASSERT_EQ(1u, g_scheduler.ready.size());
+
+  // One resume, the coroutine doesn't skip past its sleep.
+  g_scheduler.run_one();
+  ASSERT_EQ((std::vector<int>{1}), g_trace);
+  ASSERT_EQ(2, g_scheduler.run());
+  ASSERT_EQ((std::vector<int>{1, 2, 3}), g_trace);
+}
+
+static xtd::coroutine g_waiter_co;
+static bool g_waiter_event = false;
+bool waiter_poll();
+
+xtd::co_result waiter() {
+  XTD_CO_BEGIN(g_waiter_co);
+  XTD_CO_AWAIT(g_waiter_co, waiter_poll());
+  g_trace.push_back(9);
+  XTD_CO_END(g_waiter_co);
+}
+
+using waiter_task = xtd::co_task<fake_scheduler, g_scheduler, waiter>;
+
+// The event fires, and the ISR wakes the coroutine, right after the condition was checked.
+bool waiter_poll() {
+  const bool ans = g_waiter_event;
+  g_waiter_event = true;
+  waiter_task::wake();
+  return ans;
+}
+
+TEST(Coroutine, WakeWhileRunningIsNotLost) {
+  g_trace.clear();
+  ASSERT_TRUE(waiter_task::wake());
+  ASSERT_EQ(2, g_scheduler.run());
+  ASSERT_EQ((std::vector<int>{9}), g_trace);
+}
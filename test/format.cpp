@@ -0,0 +1,69 @@
+#include "xtd_uc/format.hpp"
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+
+struct format_stream_tag {};
+
+namespace xtd {
+  template <>
+  class ostream<format_stream_tag> {
+  public:
+    void put(char c) { str.push_back(c); }
+
+    std::string str;
+  };
+}  // namespace xtd
+
+using cut_type = xtd::ostream<format_stream_tag>;
+
+TEST(Format, Literals) {
+  cut_type cut;
+  xtd::format(cut, XTD_FMT("plain {{text}} only"));
+  ASSERT_EQ("plain {text} only", cut.str);
+}
+
+TEST(Format, Arguments) {
+  cut_type cut;
+  const char* name = "adc";
+  xtd::format(cut, XTD_FMT("{}{}: {} {} {} {} [{}]"), name, uint8_t(3), int16_t(-512), true, 'c',
+              INT64_MIN, xtd::pstr("pgm"));
+  ASSERT_EQ("adc3: -512 true c -9223372036854775808 [pgm]", cut.str);
+}
+
+TEST(Format, WidthAndFill) {
+  cut_type cut;
+  xtd::format(cut, XTD_FMT("[{:5}|{:05}|{:*6}|{:3}|{:4}|{:5}|{:07.2}|{:03}]"), 42, -42, "ab", 12345,
+              'x', -42, -1.5f, '-');
+  ASSERT_EQ("[   42|-0042|****ab|12345|   x|  -42|-001.50|00-]", cut.str);
+}
+
+TEST(Format, HexAndBinary) {
+  cut_type cut;
+  xtd::format(cut, XTD_FMT("{:x} {:04X} {:b} {:08b} {:x} {:x} {:X}"), 255u, 0xbeef, 5, uint8_t(3),
+              -16, 0, UINT64_MAX);
+  ASSERT_EQ("ff BEEF 101 00000011 -10 0 FFFFFFFFFFFFFFFF", cut.str);
+}
+
+TEST(Format, Floats) {
+  cut_type cut;
+  cut << xtd::setprecision(3);
+  xtd::format(cut, XTD_FMT("{} {:.1} {:8.2} {:.0}"), 1.5f, -2.25, 3.14159f, 2.5f);
+  ASSERT_EQ("1.500 -2.2     3.14 2", cut.str);
+}
+
+TEST(Format, CompileTimeValidation) {
+  using xtd::detail::format_error;
+  using xtd::detail::format_kind;
+  using xtd::detail::format_validate;
+  constexpr format_kind kinds[] = {format_kind::signed32, format_kind::floating};
+  static_assert(format_validate("{} {}", kinds, 2) == format_error::ok, "");
+  static_assert(format_validate("{} {", kinds, 2) == format_error::syntax, "");
+  static_assert(format_validate("{} }", kinds, 2) == format_error::syntax, "");
+  static_assert(format_validate("{:.x}", kinds, 1) == format_error::syntax, "");
+  static_assert(format_validate("{:x} {}", kinds, 2) == format_error::ok, "");
+  static_assert(format_validate("{} {:x}", kinds, 2) == format_error::type, "");
+  static_assert(format_validate("{} {} {}", kinds, 2) == format_error::too_few_args, "");
+  static_assert(format_validate("{}", kinds, 2) == format_error::too_many_args, "");
+}
@@ -0,0 +1,54 @@
+#include "xtd_uc/i2c.hpp"
+#include <gtest/gtest.h>
+
+using namespace xtd;
+
+namespace {
+  uint32_t scl(uint32_t f_cpu, const i2c_twi_bitrate& s) {
+    return f_cpu / (16 + 2 * s.twbr * (1UL << (2 * s.twps)));
+  }
+}  // namespace
+
+static_assert(i2c_twi_solve(16000000, 400000).rate == 400000, "Fast mode must be exact");
+static_assert(i2c_twi_solve(16000000, 400000).twbr == 12, "");
+static_assert(i2c_twi_solve(16000000, 2000000).rate == 0, "Above F_CPU / 16");
+
+TEST(I2c, TwiSolveExact) {
+  const auto s = i2c_twi_solve(16000000, 100000);
+  ASSERT_EQ(72, s.twbr);
+  ASSERT_EQ(0, s.twps);
+  ASSERT_EQ(100000u, s.rate);
+
+  ASSERT_EQ(1000000u, i2c_twi_solve(16000000, 1000000).rate);
+  ASSERT_EQ(0, i2c_twi_solve(16000000, 1000000).twbr);
+}
+
+TEST(I2c, TwiSolveNeverFaster) {
+  for (uint32_t f_cpu : {1000000UL, 8000000UL, 12000000UL, 16000000UL, 20000000UL}) {
+    for (uint32_t rate = 1000; rate <= 1000000; rate += 997) {
+      const auto s = i2c_twi_solve(f_cpu, rate);
+      if (!s.rate) {
+        ASSERT_LT(f_cpu, 16 * rate);
+        continue;
+      }
+      ASSERT_EQ(scl(f_cpu, s), s.rate);
+      ASSERT_LE(s.rate, rate);
+      if (s.twbr > 0) {
+        // One less TWBR would be too fast.
+        const uint64_t divider = 16 + 2 * (s.twbr - 1) * (1UL << (2 * s.twps));
+        ASSERT_GT(f_cpu, rate * divider);
+      }
+    }
+  }
+}
+
+TEST(I2c, TwiSolvePrescaler) {
+  // 16 MHz / (16 + 2 * 255) = 30.4 kHz is the slowest without the prescaler.
+  const auto s = i2c_twi_solve(16000000, 10000);
+  ASSERT_EQ(1, s.twps);
+  ASSERT_EQ(198, s.twbr);
+  ASSERT_EQ(10000u, s.rate);
+
+  ASSERT_EQ(3, i2c_twi_solve(16000000, 500).twps);
+  ASSERT_EQ(0u, i2c_twi_solve(16000000, 400).rate);
+}
@@ -0,0 +1,322 @@
+#include "xtd_uc/i2c_master.hpp"
+#include <gtest/gtest.h>
+
+#include <deque>
+#include <string>
+#include <vector>
+
+using namespace xtd;
+
+namespace {
+  // Simulates the TWI hardware and one slave on the bus, the states returned from on_twi() are
+  // those the ATmega TWI would produce for the calls made by the engine.
+  class fake_twi {
+  public:
+    i2c_address slave = 0x50;
+    std::vector<uint8_t> written;
+    std::vector<uint8_t> response;
+    int ack_limit = -1;        // The number of data bytes the slave acks, -1 for all
+    int lose_arbitration = 0;  // The number of upcoming starts that lose the arbitration
+    // The states of a slave access by the master that wins the next start's arbitration.
+    std::deque<i2c_state> lose_to_slave;
+    std::string log;
+
+    void master_txn(i2c_address addr, i2c_txn_mode dir) {
+      log += m_owner ? "Sr" : "S";
+      log += dir == xtd::write ? "W " : "R ";
+      if (lose_arbitration > 0) {
+        lose_arbitration--;
+        m_owner = false;
+        m_next = i2c_master_lost_arbitration;
+        return;
+      }
+      if (!lose_to_slave.empty()) {
+        m_owner = false;
+        m_slave.swap(lose_to_slave);
+        m_next = i2c_busy;
+        return;
+      }
+      m_owner = true;
+      if (addr != slave) {
+        m_next = i2c_master_nobody_home;
+      } else {
+        m_next = dir == xtd::write ? i2c_master_transmit : i2c_master_receive;
+      }
+    }
+
+    void master_release() {
+      ASSERT_TRUE(m_owner);
+      log += "P";
+      m_owner = false;
+      m_next = i2c_idle;
+    }
+
+    void transmit(i2c_data data, bool) {
+      written.push_back(data);
+      const bool acked = ack_limit < 0 || int(written.size()) <= ack_limit;
+      m_next = acked ? i2c_master_transmit : i2c_master_idle;
+    }
+
+    i2c_data receive_raw() { return m_data; }
+
+    void ack(i2c_read_response r) {
+      log += r == i2c_ack_after_next ? "A" : "N";
+      m_data = response.at(m_pos++);
+      m_next = r == i2c_ack_after_next ? i2c_master_receive : i2c_master_idle;
+    }
+
+    i2c_data receive(i2c_read_response r) {
+      auto ans = receive_raw();
+      ack(r);
+      return ans;
+    }
+
+    i2c_state on_twi() {
+      if (!m_slave.empty()) {
+        const auto ans = m_slave.front();
+        m_slave.pop_front();
+        return ans;
+      }
+      const auto ans = m_next;
+      m_next = i2c_busy;
+      return ans;
+    }
+
+  private:
+    bool m_owner = false;
+    i2c_state m_next = i2c_busy;
+    std::deque<i2c_state> m_slave;
+    uint8_t m_data = 0;
+    uint8_t m_pos = 0;
+  };
+
+  i2c_result result(const i2c_transaction& txn) { return txn.result; }
+
+  int completed = 0;
+  void on_done(i2c_transaction&) { completed++; }
+
+  template <typename Master>
+  void run(fake_twi& twi, Master& cut) {
+    for (int i = 0; i < 100 && cut.busy(); ++i) {
+      ASSERT_EQ(i2c_busy, cut.on_state(twi.on_twi()));
+    }
+    ASSERT_FALSE(cut.busy());
+  }
+}  // namespace
+
+TEST(I2cMaster, WriteThenRead) {
+  fake_twi twi;
+  twi.response = {0x12, 0x34, 0x56};
+  i2c_master<4, fake_twi> cut(twi);
+
+  const uint8_t reg[] = {0x3B, 0x01};
+  uint8_t data[3] = {};
+  i2c_transaction txn{0x50, reg, 2, data, 3, on_done, i2c_result::ok};
+  completed = 0;
+
+  ASSERT_TRUE(cut.start(txn));
+  ASSERT_TRUE(cut.busy());
+  ASSERT_EQ(i2c_result::pending, result(txn));
+  run(twi, cut);
+
+  ASSERT_EQ(i2c_result::ok, result(txn));
+  ASSERT_EQ(1, completed);
+  ASSERT_EQ(std::vector<uint8_t>({0x3B, 0x01}), twi.written);
+  ASSERT_EQ(0x12, data[0]);
+  ASSERT_EQ(0x34, data[1]);
+  ASSERT_EQ(0x56, data[2]);
+  ASSERT_EQ("SW SrR AANP", twi.log);
+}
+
+TEST(I2cMaster, ReadOnly) {
+  fake_twi twi;
+  twi.response = {0xAB};
+  i2c_master<4, fake_twi> cut(twi);
+
+  uint8_t data = 0;
+  i2c_transaction txn{0x50, nullptr, 0, &data, 1, nullptr, i2c_result::ok};
+  ASSERT_TRUE(cut.start(txn));
+  run(twi, cut);
+
+  ASSERT_EQ(i2c_result::ok, result(txn));
+  ASSERT_EQ(0xAB, data);
+  ASSERT_EQ("SR NP", twi.log);
+}
+
+TEST(I2cMaster, Probe) {
+  fake_twi twi;
+  i2c_master<4, fake_twi> cut(twi);
+
+  i2c_transaction here{0x50, nullptr, 0, nullptr, 0, nullptr, i2c_result::ok};
+  ASSERT_TRUE(cut.start(here));
+  run(twi, cut);
+  ASSERT_EQ(i2c_result::ok, result(here));
+
+  i2c_transaction absent{0x51, nullptr, 0, nullptr, 0, nullptr, i2c_result::ok};
+  ASSERT_TRUE(cut.start(absent));
+  run(twi, cut);
+  ASSERT_EQ(i2c_result::address_nack, result(absent));
+  ASSERT_EQ("SW PSW P", twi.log);
+}
+
+TEST(I2cMaster, DataNack) {
+  fake_twi twi;
+  twi.ack_limit = 1;
+  i2c_master<4, fake_twi> cut(twi);
+
+  const uint8_t out[] = {1, 2, 3};
+  uint8_t in = 0;
+  i2c_transaction txn{0x50, out, 3, &in, 1, nullptr, i2c_result::ok};
+  ASSERT_TRUE(cut.start(txn));
+  run(twi, cut);
+  ASSERT_EQ(i2c_result::data_nack, result(txn));
+  ASSERT_EQ(std::vector<uint8_t>({1, 2}), twi.written);
+  ASSERT_EQ("SW P", twi.log);
+}
+
+TEST(I2cMaster, LastByteNackIsOk) {
+  fake_twi twi;
+  twi.ack_limit = 1;
+  i2c_master<4, fake_twi> cut(twi);
+
+  const uint8_t out[] = {1, 2};
+  i2c_transaction txn{0x50, out, 2, nullptr, 0, nullptr, i2c_result::ok};
+  ASSERT_TRUE(cut.start(txn));
+  run(twi, cut);
+  ASSERT_EQ(i2c_result::ok, result(txn));
+  ASSERT_EQ("SW P", twi.log);
+}
+
+TEST(I2cMaster, ArbitrationLost) {
+  fake_twi twi;
+  twi.response = {7};
+  twi.lose_arbitration = i2c_master_retries;
+  i2c_master<4, fake_twi> cut(twi);
+
+  uint8_t in = 0;
+  i2c_transaction txn{0x50, nullptr, 0, &in, 1, nullptr, i2c_result::ok};
+  ASSERT_TRUE(cut.start(txn));
+  run(twi, cut);
+  ASSERT_EQ(i2c_result::ok, result(txn));
+  ASSERT_EQ(7, in);
+  ASSERT_EQ("SR SR SR SR NP", twi.log);
+
+  twi.log.clear();
+  twi.lose_arbitration = i2c_master_retries + 1;
+  ASSERT_TRUE(cut.start(txn));
+  run(twi, cut);
+  ASSERT_EQ(i2c_result::arbitration_lost, result(txn));
+  ASSERT_EQ("SR SR SR SR ", twi.log);
+}
+
+TEST(I2cMaster, SlaveStatesArePassedThrough) {
+  fake_twi twi;
+  i2c_master<4, fake_twi> cut(twi);
+  ASSERT_EQ(i2c_slave_addressed, cut.on_state(i2c_slave_addressed));
+  ASSERT_EQ(i2c_slave_receive, cut.on_state(i2c_slave_receive));
+  ASSERT_EQ(i2c_slave_stop, cut.on_state(i2c_slave_stop));
+  ASSERT_EQ(i2c_slave_transmit, cut.on_state(i2c_slave_transmit));
+  ASSERT_EQ(i2c_idle, cut.on_state(i2c_idle));
+}
+
+TEST(I2cMaster, ArbitrationLostToSlaveAccess) {
+  fake_twi twi;
+  twi.response = {9};
+  i2c_master<4, fake_twi> cut(twi);
+
+  // The winner writes to us, which ends with a STOP.
+  const uint8_t out[] = {1};
+  i2c_transaction txn{0x50, out, 1, nullptr, 0, nullptr, i2c_result::ok};
+  twi.lose_to_slave = {i2c_slave_addressed, i2c_slave_receive, i2c_slave_stop};
+  ASSERT_TRUE(cut.start(txn));
+  ASSERT_EQ(i2c_slave_addressed, cut.on_state(twi.on_twi()));
+  ASSERT_EQ(i2c_slave_receive, cut.on_state(twi.on_twi()));
+  ASSERT_EQ(i2c_slave_stop, cut.on_state(twi.on_twi()));
+  run(twi, cut);
+  ASSERT_EQ(i2c_result::ok, result(txn));
+  ASSERT_EQ(std::vector<uint8_t>({1}), twi.written);
+  ASSERT_EQ("SW SW P", twi.log);
+
+  // The winner reads from us, which ends in the not addressed slave mode.
+  twi.log.clear();
+  uint8_t in = 0;
+  i2c_transaction read{0x50, nullptr, 0, &in, 1, nullptr, i2c_result::ok};
+  twi.lose_to_slave = {i2c_slave_transmit, i2c_slave_transmit, i2c_idle};
+  ASSERT_TRUE(cut.start(read));
+  ASSERT_EQ(i2c_slave_transmit, cut.on_state(twi.on_twi()));
+  ASSERT_EQ(i2c_slave_transmit, cut.on_state(twi.on_twi()));
+  ASSERT_EQ(i2c_idle, cut.on_state(twi.on_twi()));
+  run(twi, cut);
+  ASSERT_EQ(i2c_result::ok, result(read));
+  ASSERT_EQ(9, in);
+  ASSERT_EQ("SR SR NP", twi.log);
+}
+
+TEST(I2cMaster, ArbitrationLostToSlaveAccessCountsAsRetry) {
+  fake_twi twi;
+  twi.lose_arbitration = i2c_master_retries;
+  twi.lose_to_slave = {i2c_slave_addressed, i2c_slave_stop};  // On the last retry
+  i2c_master<4, fake_twi> cut(twi);
+
+  i2c_transaction txn{0x50, nullptr, 0, nullptr, 0, nullptr, i2c_result::ok};
+  ASSERT_TRUE(cut.start(txn));
+  for (uint8_t i = 0; i < i2c_master_retries; ++i) {
+    ASSERT_EQ(i2c_busy, cut.on_state(twi.on_twi()));
+  }
+  ASSERT_EQ(i2c_slave_addressed, cut.on_state(twi.on_twi()));
+  ASSERT_EQ(i2c_slave_stop, cut.on_state(twi.on_twi()));
+  ASSERT_FALSE(cut.busy());
+  ASSERT_EQ(i2c_result::arbitration_lost, result(txn));
+}
+
+TEST(I2cMaster, QueuedTransactionsUseRepeatedStart) {
+  fake_twi twi;
+  twi.response = {0xA1, 0xB2};
+  i2c_master<2, fake_twi> cut(twi);
+
+  const uint8_t reg = 0x10;
+  uint8_t first = 0;
+  uint8_t last = 0;
+  i2c_transaction a{0x50, &reg, 1, &first, 1, on_done};
+  i2c_transaction b{0x51, &reg, 1, nullptr, 0, on_done};
+  i2c_transaction c{0x50, nullptr, 0, &last, 1, on_done};
+  i2c_transaction d{0x50, nullptr, 0, nullptr, 0, on_done};
+  completed = 0;
+
+  ASSERT_TRUE(cut.start(a));
+  ASSERT_TRUE(cut.start(b));
+  ASSERT_TRUE(cut.start(c));
+  ASSERT_FALSE(cut.start(d));
+  ASSERT_EQ(2, cut.queued());
+  ASSERT_EQ(i2c_result::pending, result(c));
+  run(twi, cut);
+
+  ASSERT_EQ(3, completed);
+  ASSERT_EQ(i2c_result::ok, result(a));
+  ASSERT_EQ(i2c_result::address_nack, result(b));
+  ASSERT_EQ(i2c_result::ok, result(c));
+  ASSERT_EQ(0xA1, first);
+  ASSERT_EQ(0xB2, last);
+  // A single STOP at the very end.
+  ASSERT_EQ("SW SrR NSrW SrR NP", twi.log);
+}
+
+namespace {
+  i2c_master<2, fake_twi>* chained_master;
+  i2c_transaction chained{0x50, nullptr, 0, nullptr, 0, nullptr};
+
+  void chain(i2c_transaction&) { chained_master->start(chained); }
+}  // namespace
+
+TEST(I2cMaster, StartFromCallback) {
+  fake_twi twi;
+  i2c_master<2, fake_twi> cut(twi);
+  chained_master = &cut;
+
+  i2c_transaction txn{0x50, nullptr, 0, nullptr, 0, chain};
+  chained.result = i2c_result::address_nack;
+  ASSERT_TRUE(cut.start(txn));
+  run(twi, cut);
+  ASSERT_EQ(i2c_result::ok, result(chained));
+  ASSERT_EQ("SW PSW P", twi.log);
+}
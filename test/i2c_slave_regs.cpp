@@ -0,0 +1,131 @@
+#include "xtd_uc/i2c_slave_regs.hpp"
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace xtd;
+
+namespace {
+  // Records the bus actions of the slave.
+  struct fake_twi {
+    std::vector<uint8_t> transmitted;
+    uint8_t data = 0;
+    int acks = 0;
+
+    i2c_data receive(i2c_read_response r) {
+      if (r == i2c_ack_after_next) {
+        acks++;
+      }
+      return data;
+    }
+
+    void transmit(i2c_data d, bool last_byte) {
+      ASSERT_FALSE(last_byte);
+      transmitted.push_back(d);
+    }
+  };
+
+  template <typename Regs>
+  void master_write(fake_twi& twi, Regs& cut, std::vector<uint8_t> bytes) {
+    ASSERT_EQ(i2c_busy, cut.on_state(i2c_slave_addressed));
+    for (auto b : bytes) {
+      twi.data = b;
+      ASSERT_EQ(i2c_busy, cut.on_state(i2c_slave_receive));
+    }
+  }
+
+  template <typename Regs>
+  void master_read(fake_twi& twi, Regs& cut, int n) {
+    twi.transmitted.clear();
+    for (int i = 0; i < n; ++i) {
+      ASSERT_EQ(i2c_busy, cut.on_state(i2c_slave_transmit));
+    }
+  }
+
+  uint8_t written_first;
+  uint8_t written_count;
+  int writes;
+  void on_write(uint8_t first, uint8_t count) {
+    written_first = first;
+    written_count = count;
+    writes++;
+  }
+}  // namespace
+
+TEST(I2cSlaveRegs, WriteAndReadBack) {
+  fake_twi twi;
+  i2c_slave_regs<4, fake_twi> cut(twi);
+  cut[0] = 0x11;
+
+  master_write(twi, cut, {1, 0xAA, 0xBB});
+  ASSERT_EQ(i2c_busy, cut.on_state(i2c_slave_stop));
+  ASSERT_EQ(3, twi.acks);
+  ASSERT_EQ(0x11, cut[0]);
+  ASSERT_EQ(0xAA, cut[1]);
+  ASSERT_EQ(0xBB, cut[2]);
+  ASSERT_EQ(3, cut.pointer());
+
+  // Set the pointer, then read with a repeated start. Reads past the end return 0xFF.
+  master_write(twi, cut, {0});
+  ASSERT_EQ(i2c_busy, cut.on_state(i2c_slave_stop));
+  master_read(twi, cut, 5);
+  ASSERT_EQ(std::vector<uint8_t>({0x11, 0xAA, 0xBB, 0x00, 0xFF}), twi.transmitted);
+}
+
+TEST(I2cSlaveRegs, WriteMasks) {
+  static const uint8_t masks[3] PROGMEM = {0x00, 0xFF, 0x0F};
+  fake_twi twi;
+  i2c_slave_regs<3, fake_twi> cut(twi, masks);
+  cut[0] = 0x42;
+  cut[2] = 0x50;
+
+  master_write(twi, cut, {0, 0xFF, 0x12, 0x34, 0x56});
+  ASSERT_EQ(0x42, cut[0]);
+  ASSERT_EQ(0x12, cut[1]);
+  ASSERT_EQ(0x54, cut[2]);
+  ASSERT_EQ(5, twi.acks);  // Ignored bytes are still acked
+}
+
+TEST(I2cSlaveRegs, WriteNotification) {
+  fake_twi twi;
+  i2c_slave_regs<8, fake_twi> cut(twi, nullptr, on_write);
+  writes = 0;
+
+  master_write(twi, cut, {5, 1, 2, 3, 4});
+  ASSERT_EQ(0, writes);
+  cut.on_state(i2c_slave_stop);
+  ASSERT_EQ(1, writes);
+  ASSERT_EQ(5, written_first);
+  ASSERT_EQ(3, written_count);  // Only those that fit
+
+  // Setting the pointer alone is not a write.
+  master_write(twi, cut, {2});
+  cut.on_state(i2c_slave_stop);
+  ASSERT_EQ(1, writes);
+}
+
+TEST(I2cSlaveRegs, ReadOnlyRegistersAreNotWritten) {
+  static const uint8_t masks[5] PROGMEM = {0x00, 0xFF, 0x00, 0xFF, 0x00};
+  fake_twi twi;
+  i2c_slave_regs<5, fake_twi> cut(twi, masks, on_write);
+  writes = 0;
+
+  // From the first to the last writable register written.
+  master_write(twi, cut, {0, 1, 2, 3, 4, 5});
+  cut.on_state(i2c_slave_stop);
+  ASSERT_EQ(1, writes);
+  ASSERT_EQ(1, written_first);
+  ASSERT_EQ(3, written_count);
+
+  // Only read-only registers, nothing changed.
+  master_write(twi, cut, {4, 6});
+  cut.on_state(i2c_slave_stop);
+  ASSERT_EQ(1, writes);
+}
+
+TEST(I2cSlaveRegs, OtherStatesArePassedThrough) {
+  fake_twi twi;
+  i2c_slave_regs<1, fake_twi> cut(twi);
+  ASSERT_EQ(i2c_master_transmit, cut.on_state(i2c_master_transmit));
+  ASSERT_EQ(i2c_idle, cut.on_state(i2c_idle));
+}
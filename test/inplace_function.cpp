@@ -0,0 +1,49 @@
+#include "xtd_uc/inplace_function.hpp"
+#include <gtest/gtest.h>
+
+#include "xtd_uc/queue.hpp"
+
+static int g_sum = 0;
+static void add_one() { g_sum += 1; }
+
+TEST(InplaceFunction, FunctionPointer) {
+  g_sum = 0;
+  xtd::inplace_function<void(), sizeof(void (*)())> cut = &add_one;
+  ASSERT_TRUE(bool(cut));
+  cut();
+  cut();
+  ASSERT_EQ(2, g_sum);
+}
+
+TEST(InplaceFunction, Empty) {
+  xtd::inplace_function<void()> cut;
+  ASSERT_FALSE(bool(cut));
+}
+
+TEST(InplaceFunction, CapturesAndArguments) {
+  uint8_t channel = 3;
+  uint8_t data = 40;
+  xtd::inplace_function<int(int), 2> cut = [channel, data](int x) { return channel + data + x; };
+  ASSERT_EQ(3 + 40 + 5, cut(5));
+
+  auto copy = cut;
+  channel = 0;
+  ASSERT_EQ(3 + 40 + 1, copy(1));
+}
+
+TEST(InplaceFunction, QueuedClosures) {
+  using task = xtd::inplace_function<void(), 2 * sizeof(int*)>;
+  static_assert(xtd::is_trivially_copyable<task>::value, "Must be trivially copyable");
+
+  int a = 0;
+  int b = 0;
+  xtd::queue<task, 4> q;
+  q.push([&a]() { a = 1; });
+  q.push([&a, &b]() { b = a + 1; });
+
+  while (!q.empty()) {
+    q.get()();
+  }
+  ASSERT_EQ(1, a);
+  ASSERT_EQ(2, b);
+}
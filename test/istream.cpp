@@ -0,0 +1,122 @@
+#include "xtd_uc/istream.hpp"
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+
+struct string_stream_tag {};
+
+namespace xtd {
+  template <>
+  class istream<string_stream_tag> : public istream_base<istream<string_stream_tag>> {
+  public:
+    explicit istream(const char* s) : m_data(s) {}
+
+    int_type underflow() { return *m_data ? int_type(*m_data) : eof(); }
+    void bump() { m_data++; }
+    size_type available() { return size_type(std::strlen(m_data)); }
+
+  private:
+    const char* m_data;
+  };
+}  // namespace xtd
+
+using cut_type = xtd::istream<string_stream_tag>;
+
+TEST(IStream, GetAndPeek) {
+  cut_type cut("ab");
+  ASSERT_EQ('a', cut.peek());
+  ASSERT_EQ('a', cut.get());
+  char c = 0;
+  ASSERT_TRUE(cut.get(c));
+  ASSERT_EQ('b', c);
+  ASSERT_EQ(cut_type::eof(), cut.peek());
+  ASSERT_TRUE(cut.eof());
+  ASSERT_FALSE(cut.fail());
+  ASSERT_EQ(cut_type::eof(), cut.get());
+  ASSERT_TRUE(cut.fail());
+}
+
+TEST(IStream, ReadAndReadsome) {
+  cut_type cut("hello world");
+  char buf[8] = {};
+  ASSERT_TRUE(cut.read(buf, 5));
+  ASSERT_EQ(5u, cut.gcount());
+  ASSERT_EQ(0, std::memcmp(buf, "hello", 5));
+
+  ASSERT_EQ(6u, cut.readsome(buf, sizeof(buf)));
+  ASSERT_EQ(0, std::memcmp(buf, " world", 6));
+  ASSERT_TRUE(cut.good());
+
+  ASSERT_FALSE(cut.read(buf, 1));
+  ASSERT_TRUE(cut.eof());
+}
+
+TEST(IStream, Getline) {
+  cut_type cut("first\nsecond line\nlast");
+  char buf[8];
+  ASSERT_TRUE(cut.getline(buf, sizeof(buf)));
+  ASSERT_STREQ("first", buf);
+  ASSERT_EQ(6u, cut.gcount());
+
+  ASSERT_FALSE(cut.getline(buf, sizeof(buf)));  // Doesn't fit
+  ASSERT_STREQ("second ", buf);
+  cut.clear();
+  cut.ignore(100, '\n');
+
+  ASSERT_TRUE(cut.getline(buf, sizeof(buf)));
+  ASSERT_STREQ("last", buf);
+  ASSERT_TRUE(cut.eof());
+}
+
+TEST(IStream, Integers) {
+  cut_type cut("  42 -17 +3\n-32768 255");
+  int a = 0;
+  long b = 0;
+  uint8_t c = 0;
+  int16_t d = 0;
+  unsigned e = 0;
+  ASSERT_TRUE(cut >> a >> b >> c >> d >> e);
+  ASSERT_EQ(42, a);
+  ASSERT_EQ(-17, b);
+  ASSERT_EQ(3, c);
+  ASSERT_EQ(-32768, d);
+  ASSERT_EQ(255u, e);
+  ASSERT_TRUE(cut.eof());
+}
+
+TEST(IStream, IntegerErrors) {
+  {
+    cut_type cut("256");
+    uint8_t v = 0;
+    ASSERT_FALSE(cut >> v);
+    ASSERT_EQ(255, v);
+  }
+  {
+    cut_type cut("-129");
+    int8_t v = 0;
+    ASSERT_FALSE(cut >> v);
+    ASSERT_EQ(-128, v);
+  }
+  {
+    cut_type cut("-1");
+    uint16_t v = 1;
+    ASSERT_FALSE(cut >> v);
+    ASSERT_EQ(0, v);
+  }
+  {
+    cut_type cut("x1");
+    int v = 1;
+    ASSERT_FALSE(cut >> v);
+    ASSERT_EQ(0, v);
+  }
+}
+
+TEST(IStream, Chars) {
+  cut_type cut(" a\tb");
+  char a = 0;
+  char b = 0;
+  ASSERT_TRUE(cut >> a >> b);
+  ASSERT_EQ('a', a);
+  ASSERT_EQ('b', b);
+}
@@ -0,0 +1,83 @@
+#include "xtd_uc/log.hpp"
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+  struct fake_clock {
+    struct time_point {
+      struct duration {
+        uint32_t count() const { return ticks; }
+        uint32_t ticks;
+      };
+      duration time_since_epoch() const { return {ticks}; }
+      uint32_t ticks;
+    };
+    static time_point now() { return {ticks}; }
+    static uint32_t ticks;
+  };
+  uint32_t fake_clock::ticks = 0;
+
+  std::vector<uint8_t> wire;
+  void sink(char c) { wire.push_back(uint8_t(c)); }
+
+  std::vector<std::vector<uint8_t>> frames() {
+    std::vector<std::vector<uint8_t>> ans;
+    xtd::slip_decoder<64> decoder;
+    for (auto b : wire) {
+      if (decoder.push(b) == xtd::slip_status::frame) {
+        ans.emplace_back(decoder.data(), decoder.data() + decoder.size());
+        decoder.release();
+      }
+    }
+    wire.clear();
+    return ans;
+  }
+}  // namespace
+
+TEST(Log, Id) {
+  constexpr auto a = xtd::detail::log_id("src/a.cpp", 10);
+  static_assert(a == xtd::detail::log_id("/other/dir/a.cpp", 10), "Only the base name is used");
+  static_assert(a != xtd::detail::log_id("src/a.cpp", 11), "");
+  static_assert(a != xtd::detail::log_id("src/b.cpp", 10), "");
+}
+
+TEST(Log, Records) {
+  wire.clear();
+  xtd::log_buffer<64, fake_clock> cut;
+  fake_clock::ticks = 0x12345678;
+  XTD_LOG(cut, "no arguments");
+  const uint16_t id = xtd::detail::log_id(__FILE__, __LINE__ - 1);
+  fake_clock::ticks = 7;
+  XTD_LOG(cut, "{} {:x} {} {}", int8_t(-2), uint16_t(0xBEEF), true, 1.5f);
+  ASSERT_EQ(7u + 19u, cut.size());
+
+  cut.drain<sink>();
+  ASSERT_EQ(0u, cut.size());
+  const auto f = frames();
+  ASSERT_EQ(2u, f.size());
+  const std::vector<uint8_t> first = {uint8_t(id), uint8_t(id >> 8), 0x78, 0x56, 0x34, 0x12};
+  ASSERT_EQ(first, f[0]);
+  const std::vector<uint8_t> args = {0x13, 0xFE, 0x24, 0xEF, 0xBE, 0x11, 0x01,
+                                     0x47, 0x00, 0x00, 0xC0, 0x3F};
+  ASSERT_EQ(args, std::vector<uint8_t>(f[1].begin() + 6, f[1].end()));
+  ASSERT_EQ(7, f[1][2]);
+}
+
+TEST(Log, Dropped) {
+  wire.clear();
+  xtd::log_buffer<16, fake_clock> cut;
+  for (int i = 0; i < 5; ++i) {
+    XTD_LOG(cut, "{}", uint32_t(i));
+  }
+  ASSERT_EQ(12u, cut.size());
+
+  ASSERT_TRUE(cut.drain_one<sink>());  // The drop count comes first
+  ASSERT_TRUE(cut.drain_one<sink>());
+  ASSERT_FALSE(cut.drain_one<sink>());
+  const auto f = frames();
+  ASSERT_EQ(2u, f.size());
+  ASSERT_EQ((std::vector<uint8_t>{0, 0, 4, 0}), f[0]);
+  ASSERT_EQ(0x00, f[1][7]);
+}
@@ -0,0 +1,110 @@
+#include "xtd_uc/ostream.hpp"
+#include "xtd_uc/chrono_noclock.hpp"
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <string>
+
+struct string_stream_tag {};
+
+namespace xtd {
+  template <>
+  class ostream<string_stream_tag> {
+  public:
+    void put(char c) { str.push_back(c); }
+
+    std::string str;
+  };
+}  // namespace xtd
+
+using cut_type = xtd::ostream<string_stream_tag>;
+
+template <typename T>
+std::string format(T v) {
+  cut_type cut;
+  cut << v;
+  return cut.str;
+}
+
+template <typename T>
+void check_limits() {
+  ASSERT_EQ(std::to_string(std::numeric_limits<T>::max()), format(std::numeric_limits<T>::max()));
+  ASSERT_EQ(std::to_string(std::numeric_limits<T>::min()), format(std::numeric_limits<T>::min()));
+  ASSERT_EQ("0", format(T(0)));
+  ASSERT_EQ("1", format(T(1)));
+}
+
+TEST(OStream, IntegerLimits) {
+  check_limits<int8_t>();
+  check_limits<uint8_t>();
+  check_limits<int16_t>();
+  check_limits<uint16_t>();
+  check_limits<int32_t>();
+  check_limits<uint32_t>();
+  check_limits<int64_t>();
+  check_limits<uint64_t>();
+}
+
+TEST(OStream, Integers) {
+  for (int64_t v = 1; v < 1000000000000000000LL; v = v * 7 + 3) {
+    ASSERT_EQ(std::to_string(v), format(v));
+    ASSERT_EQ(std::to_string(-v), format(-v));
+    ASSERT_EQ(std::to_string(uint32_t(v)), format(uint32_t(v)));
+    ASSERT_EQ(std::to_string(int16_t(v)), format(int16_t(v)));
+  }
+  ASSERT_EQ("100", format(uint8_t(100)));
+  ASSERT_EQ("10000", format(uint16_t(10000)));
+  ASSERT_EQ("10000000000000000000", format(uint64_t(10000000000000000000ULL)));
+}
+
+TEST(OStream, Strings) {
+  cut_type cut;
+  cut << "a" << xtd::pstr("b") << true << false;
+  ASSERT_EQ("abtruefalse", cut.str);
+}
+
+std::string printf_float(float v, int precision) {
+  char buf[64];
+  std::snprintf(buf, sizeof(buf), "%.*f", precision, double(v));
+  return buf;
+}
+
+TEST(OStream, Floats) {
+  const float values[] = {0.0f,     -0.0f,      1.0f,  0.1f,          -2.71828f,
+                          3.14159f, 99.999f,    1e-7f, 1.234e-30f,    12345.678f,
+                          1e9f,     1.5e15f,    1e-45f, 4294967296.0f, -123456.789f};
+  for (auto v : values) {
+    for (uint8_t p = 0; p <= xtd::max_precision; ++p) {
+      cut_type cut;
+      cut << xtd::setprecision(p) << v;
+      ASSERT_EQ(printf_float(v, p), cut.str) << p;
+    }
+  }
+  cut_type cut;
+  cut << xtd::setprecision(20) << 0.5f;
+  ASSERT_EQ("0.500000000", cut.str);
+}
+
+TEST(OStream, FloatSpecials) {
+  cut_type cut;
+  cut << xtd::setprecision(2) << std::numeric_limits<float>::infinity() << "|"
+      << -std::numeric_limits<float>::quiet_NaN() << "|" << 3e20f << "|" << -1e38f;
+  ASSERT_EQ("inf|-nan|3.00e20|-1.00e38", cut.str);
+}
+
+TEST(OStream, Quantities) {
+  using namespace xtd::chrono;
+  cut_type cut;
+  using millivolts = xtd::units::quantity<int16_t, xtd::units::volt, xtd::milli>;
+  cut << xtd::setprecision(3) << milliseconds(250) << "|" << millivolts(1500);
+  ASSERT_EQ("00:00:00.250|1.500 m^2*kg*A^-1*s^-3", cut.str);
+}
+
+TEST(OStream, Durations) {
+  using namespace xtd::chrono;
+  cut_type cut;
+  cut << milliseconds(3723004) << "|" << seconds(-61) << "|" << hours(100);
+  ASSERT_EQ("01:02:03.004|-00:01:01.000|100:00:00.000", cut.str);
+}
@@ -0,0 +1,94 @@
+#include "xtd_uc/power.hpp"
+#include <gtest/gtest.h>
+
+using xtd::power_deepest_sleep_mode;
+using xtd::power_user;
+using xtd::sleep_mode;
+
+namespace {
+  class Power : public ::testing::Test {
+  protected:
+    // The application has opted in to the deeper sleep modes.
+    void SetUp() override {
+      xtd::detail::power_state<>::active = 0;
+      ASSR = 0;
+    }
+    void TearDown() override {
+      xtd::detail::power_state<>::active = xtd::detail::power_reset_active;
+      ASSR = 0;
+    }
+
+    static xtd::chrono::steady_clock::duration ticks(long long n) {
+      return xtd::chrono::steady_clock::duration(n);
+    }
+  };
+}  // namespace
+
+TEST_F(Power, NothingActive) { ASSERT_EQ(sleep_mode::power_down, power_deepest_sleep_mode()); }
+
+TEST_F(Power, IdleUntilTheApplicationOptsIn) {
+  xtd::detail::power_state<>::active = xtd::detail::power_reset_active;
+  ASSERT_EQ(sleep_mode::idle, power_deepest_sleep_mode());
+  xtd::power_set_active(power_user::app, false);
+  ASSERT_EQ(sleep_mode::power_down, power_deepest_sleep_mode());
+}
+
+TEST_F(Power, IoClockUsers) {
+  xtd::power_set_active(power_user::i2c, true);
+  xtd::power_set_active(power_user::uart, true);
+  ASSERT_EQ(sleep_mode::idle, power_deepest_sleep_mode());
+  xtd::power_set_active(power_user::uart, false);
+  ASSERT_EQ(sleep_mode::idle, power_deepest_sleep_mode());
+  xtd::power_set_active(power_user::i2c, false);
+  ASSERT_EQ(sleep_mode::power_down, power_deepest_sleep_mode());
+}
+
+TEST_F(Power, EnabledAdcNeverSelectsNoiseReduction) {
+  // As registered by adc_enable() and kept during adc_continuous_start().
+  xtd::power_set_active(power_user::adc, true);
+  ASSERT_EQ(sleep_mode::idle, power_deepest_sleep_mode());
+  ASSR = _BV(AS2);
+  xtd::power_set_active(power_user::chrono, true);
+  ASSERT_EQ(sleep_mode::idle, power_deepest_sleep_mode());
+  ASSERT_EQ(sleep_mode::idle, power_deepest_sleep_mode(ticks(1000)));
+}
+
+TEST_F(Power, SynchronousTimer2NeedsIdle) {
+  xtd::power_set_active(power_user::chrono, true);
+  ASSERT_EQ(sleep_mode::idle, power_deepest_sleep_mode());
+  xtd::power_set_active(power_user::adc, true);
+  ASSERT_EQ(sleep_mode::idle, power_deepest_sleep_mode());
+  ASSERT_EQ(sleep_mode::idle, power_deepest_sleep_mode(ticks(1000)));
+}
+
+TEST_F(Power, AsynchronousTimer2) {
+  ASSR = _BV(AS2);
+  xtd::power_set_active(power_user::chrono, true);
+  ASSERT_EQ(sleep_mode::power_save, power_deepest_sleep_mode());
+  xtd::power_set_active(power_user::adc, true);
+  ASSERT_EQ(sleep_mode::idle, power_deepest_sleep_mode());
+}
+
+TEST_F(Power, NoPowerSaveWhileTimer2IsUpdating) {
+  ASSR = _BV(AS2) | _BV(OCR2AUB);  // wake_at() has just written OCR2A
+  xtd::power_set_active(power_user::chrono, true);
+  ASSERT_EQ(sleep_mode::idle, power_deepest_sleep_mode());
+  ASSERT_EQ(sleep_mode::idle, power_deepest_sleep_mode(ticks(1000)));
+  ASSR = _BV(AS2) | _BV(TCN2UB);
+  ASSERT_EQ(sleep_mode::idle, power_deepest_sleep_mode(ticks(1000)));
+  ASSR = _BV(AS2);
+  ASSERT_EQ(sleep_mode::power_save, power_deepest_sleep_mode(ticks(1000)));
+}
+
+TEST_F(Power, NearDeadlineStaysInIdle) {
+  ASSR = _BV(AS2);
+  xtd::power_set_active(power_user::chrono, true);
+  // 16384 cycles are 16 ticks of 1024 cycles.
+  ASSERT_EQ(sleep_mode::power_save, power_deepest_sleep_mode(ticks(17)));
+  ASSERT_EQ(sleep_mode::idle, power_deepest_sleep_mode(ticks(16)));
+  ASSERT_EQ(sleep_mode::idle, power_deepest_sleep_mode(ticks(-3)));
+
+  // Modes that keep the clock running are unaffected.
+  xtd::power_set_active(power_user::uart, true);
+  ASSERT_EQ(sleep_mode::idle, power_deepest_sleep_mode(ticks(100)));
+}
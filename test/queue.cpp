@@ -18,3 +18,111 @@ TEST(Queue, Full) {
     ASSERT_FALSE(cut.full());
   }
 }
+
+template <typename Queue>
+void verify_fifo_order(Queue& cut) {
+  // Run the indices past the end of the buffer (and their 8 bit range) a few times.
+  uint8_t next_in = 0;
+  uint8_t next_out = 0;
+  for (int i = 0; i < 1000; ++i) {
+    while (!cut.full()) {
+      cut.push(next_in++);
+    }
+    ASSERT_EQ(cut.capacity(), cut.size());
+    for (int j = 0; j < 3; ++j) {
+      ASSERT_EQ(next_out++, cut.get());
+    }
+    ASSERT_EQ(cut.capacity() - 3, cut.size());
+  }
+
+  while (!cut.empty()) {
+    ASSERT_EQ(next_out++, cut.get());
+  }
+  ASSERT_EQ(0, cut.size());
+  ASSERT_EQ(next_in, next_out);
+}
+
+TEST(Queue, FifoOrderPowerOfTwo) {
+  xtd::queue<uint8_t, 16> cut;
+  static_assert(sizeof(cut) == 16 + 2, "Power of two queue must not waste a slot");
+  verify_fifo_order(cut);
+}
+
+TEST(Queue, FifoOrderOtherSize) {
+  xtd::queue<uint8_t, 7> cut;
+  static_assert(sizeof(cut) == 7 + 2, "Queue must not waste a slot");
+  verify_fifo_order(cut);
+}
+
+TEST(Queue, Clear) {
+  xtd::queue<uint8_t, 5> cut;
+  cut.push(1);
+  cut.push(2);
+  cut.pop();
+  cut.clear();
+  ASSERT_TRUE(cut.empty());
+  ASSERT_EQ(0, cut.size());
+  cut.push(3);
+  ASSERT_EQ(3, cut.peek());
+}
+
+TEST(Queue, BulkPushPop) {
+  xtd::queue<uint8_t, 8> cut;
+  const uint8_t in[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  uint8_t out[10] = {};
+
+  // Move the indices so that the bulk operations have to wrap around.
+  cut.push(0xFF);
+  cut.push(0xFF);
+  cut.push(0xFF);
+  cut.pop();
+  cut.pop();
+  cut.pop();
+
+  ASSERT_EQ(8, cut.push_n(in, 10));
+  ASSERT_TRUE(cut.full());
+  ASSERT_EQ(0, cut.push_n(in, 10));
+
+  ASSERT_EQ(5, cut.pop_n(out, 5));
+  ASSERT_EQ(3, cut.size());
+  ASSERT_EQ(3, cut.pop_n(out + 5, 5));
+  ASSERT_TRUE(cut.empty());
+
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_EQ(in[i], out[i]);
+  }
+}
+
+TEST(Queue, ContiguousRegions) {
+  xtd::queue<uint8_t, 6> cut;
+  for (uint8_t i = 0; i < 4; ++i) {
+    cut.push(i);
+  }
+  cut.consume(3);  // read index at 3, one element stored
+
+  auto w = cut.writable();
+  ASSERT_EQ(5, w.size());
+  ASSERT_EQ(2, w.first.size());  // slots 4 and 5
+  ASSERT_EQ(3, w.second.size());  // slots 0 to 2
+  for (auto& x : w.first) {
+    x = 10;
+  }
+  for (auto& x : w.second) {
+    x = 20;
+  }
+  cut.commit(w.size());
+  ASSERT_TRUE(cut.full());
+
+  auto r = cut.readable();
+  ASSERT_EQ(6, r.size());
+  ASSERT_EQ(3, r.first.size());
+  ASSERT_EQ(3, r.second.size());
+  ASSERT_EQ(3, r.first[0]);
+  ASSERT_EQ(10, r.first[2]);
+  ASSERT_EQ(20, r.second[0]);
+
+  cut.consume(4);
+  ASSERT_EQ(2, cut.size());
+  ASSERT_EQ(20, cut.get());
+  ASSERT_TRUE(cut.readable().second.empty());
+}
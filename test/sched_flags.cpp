@@ -0,0 +1,74 @@
+#include "xtd_uc/sched_flags.hpp"
+#include <gtest/gtest.h>
+
+#include <type_traits>
+#include <vector>
+
+namespace {
+  std::vector<char> trace;
+  void task_a();
+  void task_b() { trace.push_back('b'); }
+  void task_c() { trace.push_back('c'); }
+
+  struct scheduler : xtd::flag_scheduler<task_a, task_b, task_c> {
+    using flag_scheduler::run_once;
+
+    int run_ready() {
+      int n = 0;
+      while (run_once()) {
+        ++n;
+      }
+      return n;
+    }
+  };
+
+  scheduler g_cut;
+
+  // Posts itself once, and a task with a lower index.
+  void task_a() {
+    trace.push_back('a');
+    if (trace.size() == 1) {
+      g_cut.post<task_a>();
+    }
+  }
+}  // namespace
+
+using xtd::detail::index_of;
+using task_type = void (*)();
+
+static_assert(index_of<task_type, task_a, task_a, task_b, task_c>::value == 0, "");
+static_assert(index_of<task_type, task_c, task_a, task_b, task_c>::value == 2, "");
+static_assert(index_of<int, 7, 1, 7, 7>::value == 1, "The first match");
+static_assert(std::is_same<xtd::detail::flag_mask_t<8>, uint8_t>::value, "");
+static_assert(std::is_same<xtd::detail::flag_mask_t<9>, uint16_t>::value, "");
+static_assert(std::is_same<xtd::detail::flag_mask_t<17>, uint32_t>::value, "");
+
+TEST(SchedFlags, DispatchInIndexOrder) {
+  trace.clear();
+  g_cut.post<task_c>();
+  g_cut.post<task_b>();
+  ASSERT_TRUE(g_cut.pending<task_b>());
+  ASSERT_FALSE(g_cut.pending<task_a>());
+
+  ASSERT_EQ(2, g_cut.run_ready());
+  ASSERT_EQ(std::vector<char>({'b', 'c'}), trace);
+  ASSERT_FALSE(g_cut.pending<task_b>());
+  ASSERT_FALSE(g_cut.run_once());
+}
+
+TEST(SchedFlags, PostingPendingTaskRunsItOnce) {
+  trace.clear();
+  g_cut.post<task_b>();
+  g_cut.post_from_isr<task_b>();
+  g_cut.post<task_b>();
+  ASSERT_EQ(1, g_cut.run_ready());
+  ASSERT_EQ(std::vector<char>({'b'}), trace);
+}
+
+TEST(SchedFlags, PostDuringExecutionRunsAgain) {
+  trace.clear();
+  g_cut.post<task_c>();
+  g_cut.post<task_a>();
+  ASSERT_EQ(3, g_cut.run_ready());
+  ASSERT_EQ(std::vector<char>({'a', 'a', 'c'}), trace);
+}
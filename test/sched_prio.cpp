@@ -0,0 +1,71 @@
+#include "xtd_uc/sched_prio.hpp"
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace {
+  std::vector<char> trace;
+  void task_a() { trace.push_back('a'); }
+  void task_b() { trace.push_back('b'); }
+  void task_c() { trace.push_back('c'); }
+
+  struct scheduler : xtd::priority_scheduler<3, 2> {
+    using priority_scheduler::run_once;
+
+    void run_ready() {
+      while (run_once()) {
+      }
+    }
+  };
+
+  // Schedules a task of a higher priority than its own.
+  scheduler* g_cut;
+  void schedule_b_high() {
+    trace.push_back('x');
+    g_cut->schedule(task_b, 0);
+  }
+}  // namespace
+
+TEST(SchedPrio, HighestPriorityFirst) {
+  trace.clear();
+  scheduler cut;
+  ASSERT_TRUE(cut.schedule(task_c, 2));
+  ASSERT_TRUE(cut.schedule(task_a, 1));
+  ASSERT_TRUE(cut.schedule(task_b, 0));
+  ASSERT_TRUE(cut.schedule(task_c, 1));
+
+  cut.run_ready();
+  ASSERT_EQ(std::vector<char>({'b', 'a', 'c', 'c'}), trace);
+  ASSERT_FALSE(cut.run_once());
+}
+
+TEST(SchedPrio, HigherPriorityScheduledByTask) {
+  trace.clear();
+  scheduler cut;
+  g_cut = &cut;
+  ASSERT_TRUE(cut.schedule(schedule_b_high, 2));
+  ASSERT_TRUE(cut.schedule(task_c, 2));
+
+  cut.run_ready();
+  ASSERT_EQ(std::vector<char>({'x', 'b', 'c'}), trace);
+}
+
+TEST(SchedPrio, FullLevel) {
+  trace.clear();
+  scheduler cut;
+  ASSERT_TRUE(cut.schedule(task_a, 1));
+  ASSERT_TRUE(cut.schedule(task_a, 1));
+  ASSERT_FALSE(cut.schedule(task_b, 1));
+  ASSERT_TRUE(cut.schedule(task_b, 0));  // Other levels are unaffected
+
+  cut.run_ready();
+  ASSERT_EQ(std::vector<char>({'b', 'a', 'a'}), trace);
+}
+
+TEST(SchedPrio, PriorityOutOfRange) {
+  trace.clear();
+  scheduler cut;
+  ASSERT_FALSE(cut.schedule(task_a, 3));
+  ASSERT_FALSE(cut.schedule(task_a, 255));
+  ASSERT_FALSE(cut.run_once());
+}
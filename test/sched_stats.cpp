@@ -0,0 +1,100 @@
+#include "xtd_uc/sched_stats.hpp"
+#include <gtest/gtest.h>
+
+#include "xtd_uc/queue.hpp"
+
+#include <type_traits>
+
+namespace {
+  struct fake_clock {
+    using duration = xtd::chrono::steady_clock::duration;
+    using time_point = xtd::chrono::steady_clock::time_point;
+
+    static time_point now() { return time_point(duration(ticks)); }
+    static long long ticks;
+  };
+  long long fake_clock::ticks = 0;
+
+  void task_a() {}
+  void task_b() {}
+  void task_c() {}
+
+  using stats_type = xtd::sched_stats<2, void (*)(), fake_clock>;
+
+  // Drives the hooks the way fcfs_scheduler does.
+  struct fake_scheduler : stats_type {
+    bool schedule(void (*t)()) {
+      if (tasks.full()) {
+        on_reject();
+        return false;
+      }
+      tasks.push(make_entry(t));
+      on_schedule(tasks.size());
+      return true;
+    }
+
+    void dispatch(long long run_ticks) {
+      const auto e = tasks.get();
+      on_dispatch(e);
+      entry_task(e)();
+      fake_clock::ticks += run_ticks;
+      on_complete();
+    }
+
+    xtd::queue<entry<void (*)()>, 3> tasks;
+  };
+}  // namespace
+
+TEST(SchedStats, DisabledIsFree) {
+  static_assert(std::is_empty<xtd::no_sched_stats>::value, "");
+  static_assert(std::is_same<xtd::no_sched_stats::entry<void (*)()>, void (*)()>::value, "");
+}
+
+TEST(SchedStats, RecordsPerTask) {
+  fake_clock::ticks = 65530;  // Exercise the 16 bit wrap around
+  fake_scheduler cut;
+
+  ASSERT_TRUE(cut.schedule(task_a));
+  ASSERT_TRUE(cut.schedule(task_b));
+  fake_clock::ticks += 10;
+  cut.dispatch(5);  // task_a: latency 10, run 5
+  cut.dispatch(7);  // task_b: latency 15, run 7
+  ASSERT_TRUE(cut.schedule(task_a));
+  fake_clock::ticks += 2;
+  cut.dispatch(3);  // task_a: latency 2, run 3
+
+  ASSERT_EQ(2, cut.size());
+  auto a = cut.find(task_a);
+  ASSERT_NE(nullptr, a);
+  EXPECT_EQ(2, a->calls);
+  EXPECT_EQ(5, a->max_run);
+  EXPECT_EQ(8u, a->total_run);
+  EXPECT_EQ(10, a->max_latency);
+
+  auto b = cut.find(task_b);
+  ASSERT_NE(nullptr, b);
+  EXPECT_EQ(1, b->calls);
+  EXPECT_EQ(7, b->max_run);
+  EXPECT_EQ(15, b->max_latency);
+}
+
+TEST(SchedStats, QueueUsage) {
+  fake_scheduler cut;
+  ASSERT_TRUE(cut.schedule(task_a));
+  ASSERT_TRUE(cut.schedule(task_b));
+  ASSERT_TRUE(cut.schedule(task_c));
+  ASSERT_FALSE(cut.schedule(task_a));
+  cut.dispatch(1);
+  cut.dispatch(1);
+  cut.dispatch(1);  // No slot left for task_c
+
+  EXPECT_EQ(3, cut.high_water_mark());
+  EXPECT_EQ(1, cut.rejected());
+  EXPECT_EQ(2, cut.size());
+  EXPECT_EQ(nullptr, cut.find(task_c));
+
+  cut.reset();
+  EXPECT_EQ(0, cut.high_water_mark());
+  EXPECT_EQ(0, cut.rejected());
+  EXPECT_EQ(0, cut.size());
+}
@@ -0,0 +1,139 @@
+#include "xtd_uc/sched_timer.hpp"
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace {
+  struct fake_clock {
+    using duration = xtd::chrono::steady_clock::duration;
+    using time_point = xtd::chrono::steady_clock::time_point;
+
+    static time_point now() { return time_point(duration(ticks)); }
+
+    // Simulates time passing while the compare match is armed.
+    static bool wake_at(const time_point& t) {
+      ticks += wake_at_delay;
+      return now() < t;
+    }
+
+    static long long ticks;
+    static long long wake_at_delay;
+  };
+  long long fake_clock::ticks = 0;
+  long long fake_clock::wake_at_delay = 0;
+
+  std::vector<char> trace;
+  void task_a() { trace.push_back('a'); }
+  void task_b() { trace.push_back('b'); }
+  void task_c() { trace.push_back('c'); }
+
+  struct scheduler : xtd::timer_scheduler<2, 3, fake_clock> {
+    using timer_scheduler::run_once;
+    using timer_scheduler::sleep;
+
+    // Runs everything that is ready.
+    void run_ready() {
+      while (run_once()) {
+      }
+    }
+  };
+
+  fake_clock::duration ticks(long long n) { return fake_clock::duration(n); }
+
+  class SchedTimer : public ::testing::Test {
+  protected:
+    void SetUp() override {
+      fake_clock::ticks = 1000;
+      fake_clock::wake_at_delay = 0;
+      trace.clear();
+    }
+  };
+}  // namespace
+
+TEST_F(SchedTimer, ExpiresInDeadlineOrder) {
+  scheduler cut;
+  ASSERT_TRUE(cut.schedule_after(ticks(30), task_a));
+  ASSERT_TRUE(cut.schedule_after(ticks(10), task_b));
+  ASSERT_TRUE(cut.schedule_after(ticks(20), task_c));
+
+  cut.run_ready();
+  ASSERT_TRUE(trace.empty());
+
+  fake_clock::ticks += 10;
+  cut.run_ready();
+  ASSERT_EQ(std::vector<char>({'b'}), trace);
+
+  fake_clock::ticks += 20;
+  cut.run_ready();
+  ASSERT_EQ(std::vector<char>({'b', 'c', 'a'}), trace);
+}
+
+TEST_F(SchedTimer, TableFull) {
+  scheduler cut;
+  ASSERT_TRUE(cut.schedule_after(ticks(1), task_a));
+  ASSERT_TRUE(cut.schedule_after(ticks(1), task_b));
+  ASSERT_TRUE(cut.schedule_after(ticks(1), task_c));
+  ASSERT_FALSE(cut.schedule_after(ticks(1), task_a));
+}
+
+TEST_F(SchedTimer, ExpiredTimersWaitForRoomInReadyQueue) {
+  scheduler cut;
+  ASSERT_TRUE(cut.schedule_after(ticks(1), task_a));
+  ASSERT_TRUE(cut.schedule_after(ticks(2), task_b));
+  ASSERT_TRUE(cut.schedule_after(ticks(3), task_c));
+  ASSERT_TRUE(cut.schedule(task_c));
+  fake_clock::ticks += 5;
+
+  cut.run_ready();
+  ASSERT_EQ(std::vector<char>({'c', 'a', 'b', 'c'}), trace);
+}
+
+TEST_F(SchedTimer, Periodic) {
+  scheduler cut;
+  ASSERT_TRUE(cut.schedule_every(ticks(10), task_a));
+
+  for (int i = 0; i < 3; ++i) {
+    fake_clock::ticks += 10;
+    cut.run_ready();
+  }
+  ASSERT_EQ(std::vector<char>({'a', 'a', 'a'}), trace);
+
+  // Late by more than a period, the missed deadline runs once now and the period doesn't drift.
+  fake_clock::ticks += 15;
+  cut.run_ready();
+  ASSERT_EQ(4u, trace.size());
+  fake_clock::ticks += 5;
+  cut.run_ready();
+  ASSERT_EQ(5u, trace.size());
+}
+
+TEST_F(SchedTimer, Cancel) {
+  scheduler cut;
+  ASSERT_TRUE(cut.schedule_every(ticks(10), task_a));
+  ASSERT_TRUE(cut.schedule_after(ticks(5), task_b));
+  ASSERT_TRUE(cut.schedule_after(ticks(20), task_a));
+  cut.cancel(task_a);
+
+  fake_clock::ticks += 50;
+  cut.run_ready();
+  ASSERT_EQ(std::vector<char>({'b'}), trace);
+
+  // The freed slots can be reused.
+  ASSERT_TRUE(cut.schedule_after(ticks(1), task_a));
+  ASSERT_TRUE(cut.schedule_after(ticks(1), task_c));
+  ASSERT_TRUE(cut.schedule_after(ticks(1), task_a));
+}
+
+TEST_F(SchedTimer, DeadlinePassesWhileArming) {
+  scheduler cut;
+  ASSERT_TRUE(cut.schedule_after(ticks(2), task_a));
+
+  fake_clock::wake_at_delay = 5;
+  ASSERT_FALSE(cut.sleep());
+  ASSERT_TRUE(cut.run_once());
+  ASSERT_EQ(std::vector<char>({'a'}), trace);
+
+  fake_clock::wake_at_delay = 0;
+  ASSERT_TRUE(cut.schedule_after(ticks(2), task_b));
+  ASSERT_TRUE(cut.sleep());
+}
@@ -0,0 +1,104 @@
+#include "xtd_uc/slip.hpp"
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+namespace {
+  std::vector<uint8_t> wire;
+  void sink(char c) { wire.push_back(uint8_t(c)); }
+
+  template <typename Decoder>
+  std::vector<xtd::slip_status> feed(Decoder& cut, const std::vector<uint8_t>& bytes) {
+    std::vector<xtd::slip_status> ans;
+    for (auto b : bytes) {
+      const auto s = cut.push(b);
+      if (s != xtd::slip_status::pending) {
+        ans.push_back(s);
+      }
+    }
+    return ans;
+  }
+}  // namespace
+
+TEST(Crc, Ccitt) {
+  xtd::crc16_ccitt cut;
+  cut.write(reinterpret_cast<const uint8_t*>("123456789"), 9);
+  ASSERT_EQ(0x29B1, cut.value());
+
+  // The residue over data and CRC, most significant byte first, is zero.
+  cut.put(0x29);
+  cut.put(0xB1);
+  ASSERT_EQ(0, cut.value());
+}
+
+TEST(Slip, EncodeEscapes) {
+  wire.clear();
+  xtd::slip_encoder<sink> cut;
+  const uint8_t payload[] = {0x01, 0xC0, 0xDB, 0x02};
+  cut.begin();
+  cut.write(payload, sizeof(payload));
+  cut.end();
+
+  xtd::crc16_ccitt crc;
+  crc.write(payload, sizeof(payload));
+  ASSERT_EQ(0x3D1C, crc.value());  // No escapes needed in the CRC for this payload
+
+  const std::vector<uint8_t> expected = {0xC0, 0x01, 0xDB, 0xDC, 0xDB,
+                                       0xDD, 0x02, 0x3D, 0x1C, 0xC0};
+  ASSERT_EQ(expected, wire);
+}
+
+TEST(Slip, RoundTrip) {
+  wire.clear();
+  xtd::slip_encoder<sink> enc;
+  for (int n = 0; n < 3; ++n) {
+    enc.begin();
+    for (int i = 0; i < 256; i += 3) {
+      enc.put(uint8_t(i + n));
+    }
+    enc.end();
+  }
+
+  xtd::slip_decoder<100> cut;
+  int frames = 0;
+  for (auto b : wire) {
+    const auto s = cut.push(b);
+    ASSERT_NE(xtd::slip_status::crc_error, s);
+    if (s == xtd::slip_status::frame) {
+      ASSERT_EQ(86, cut.size());
+      for (int i = 0; i < cut.size(); ++i) {
+        ASSERT_EQ(uint8_t(3 * i + frames), cut.data()[i]);
+      }
+      frames++;
+      cut.release();
+    }
+  }
+  ASSERT_EQ(3, frames);
+}
+
+TEST(Slip, DecodeErrors) {
+  xtd::slip_decoder<4> cut;
+  using s = xtd::slip_status;
+
+  // Corrupted CRC, too short and noise before the first END.
+  ASSERT_EQ(std::vector<s>{s::crc_error}, feed(cut, {0xC0, 0x01, 0x9E, 0x27, 0xC0}));
+  ASSERT_EQ(std::vector<s>{s::crc_error}, feed(cut, {0x01, 0xC0}));
+  ASSERT_EQ(std::vector<s>{s::escape_error}, feed(cut, {0xDB, 0x01, 0xC0}));
+  ASSERT_EQ(std::vector<s>{s::overrun}, feed(cut, {1, 2, 3, 4, 5, 6, 7, 0xC0}));
+  ASSERT_FALSE(cut.available());
+
+  // A frame that arrives before release() is dropped, the held one is kept.
+  wire.clear();
+  xtd::slip_encoder<sink> enc;
+  enc.begin();
+  enc.put(0xC0);
+  enc.end();
+  ASSERT_EQ(std::vector<s>{s::frame}, feed(cut, wire));
+  ASSERT_EQ(std::vector<s>{s::overrun}, feed(cut, {0x05, 0x06, 0xC0}));
+  ASSERT_TRUE(cut.available());
+  ASSERT_EQ(1, cut.size());
+  ASSERT_EQ(0xC0, cut.data()[0]);
+  cut.release();
+  ASSERT_EQ(std::vector<s>{s::frame}, feed(cut, wire));
+}
@@ -0,0 +1,59 @@
+#include "xtd_uc/spsc_queue.hpp"
+#include <gtest/gtest.h>
+
+TEST(SpscQueue, Full) {
+  constexpr auto n = 32;
+  xtd::spsc_queue<char, n> cut;
+
+  for (int i = 0; i < n - 1; ++i) {
+    cut.push(i);
+  }
+
+  ASSERT_FALSE(cut.full());
+
+  for (int i = 0; i < 3 * n; ++i) {
+    cut.push(i);
+    ASSERT_TRUE(cut.full());
+    ASSERT_FALSE(cut.try_push(i));
+    cut.pop();
+    ASSERT_FALSE(cut.full());
+  }
+}
+
+TEST(SpscQueue, OrderAcrossIndexWrap) {
+  xtd::spsc_queue<uint8_t, 8> cut;
+
+  // Run the free running indices past their 8 bit range a few times.
+  uint8_t next_in = 0;
+  uint8_t next_out = 0;
+  for (int i = 0; i < 1000; ++i) {
+    while (!cut.full()) {
+      cut.push(next_in++);
+    }
+    ASSERT_EQ(8, cut.size());
+    for (int j = 0; j < 5; ++j) {
+      ASSERT_EQ(next_out++, cut.get());
+    }
+    ASSERT_EQ(3, cut.size());
+  }
+
+  while (!cut.empty()) {
+    ASSERT_EQ(next_out++, cut.get());
+  }
+  ASSERT_EQ(next_in, next_out);
+}
+
+TEST(SpscQueue, PushN) {
+  xtd::spsc_queue<uint8_t, 4> cut;
+  const uint8_t data[] = {1, 2, 3, 4, 5, 6};
+
+  ASSERT_EQ(3, cut.push_n(data, 3));
+  ASSERT_EQ(1, cut.get());
+  ASSERT_EQ(2, cut.push_n(data + 3, 3));  // Wraps around, then full
+  ASSERT_TRUE(cut.full());
+  for (uint8_t expected : {2, 3, 4, 5}) {
+    ASSERT_EQ(expected, cut.get());
+  }
+  ASSERT_EQ(0, cut.push_n(data, 0));
+  ASSERT_TRUE(cut.empty());
+}
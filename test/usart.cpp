@@ -0,0 +1,106 @@
+#include "xtd_uc/usart.hpp"
+#include <gtest/gtest.h>
+
+using link_type = xtd::uart<0, 9600, xtd::uart_frame<8, xtd::uart_parity::even, 2>, 4, 2>;
+using debug_type = xtd::uart<1, 250000, xtd::uart_frame<7>, 2, 1>;
+
+TEST(Usart, Configure) {
+  static_assert(link_type::baud::ubrr == 103, "9600 baud at 16 MHz");
+  static_assert(debug_type::baud::ubrr == 3, "250k baud at 16 MHz");
+  static_assert(link_type::frame::bits == 12, "");
+
+  PRR = 0xFF;
+  link_type link;
+  debug_type debug;
+  link.configure();
+  debug.configure();
+
+  EXPECT_EQ(103, UBRR0);
+  EXPECT_EQ(0, UCSR0A);
+  EXPECT_EQ(0b00101110, UCSR0C);
+  EXPECT_EQ(_BV(RXEN0) | _BV(RXCIE0) | _BV(TXEN0), UCSR0B);
+
+  EXPECT_EQ(3, UBRR1);
+  EXPECT_EQ(0b00000100, UCSR1C);
+  EXPECT_EQ(0xFF & ~_BV(PRUSART0) & ~_BV(PRUSART1), PRR);
+
+  debug.disable();
+  EXPECT_EQ(0, UCSR1B);
+  EXPECT_EQ(0xFF & ~_BV(PRUSART0), PRR);
+}
+
+TEST(Usart, BaudSelection) {
+  // Normal speed is preferred when both modes are equally good.
+  using b9600 = xtd::uart_baud<16000000, 9600>;
+  static_assert(!b9600::x2 && b9600::ubrr == 103 && b9600::error_ppm == 1602, "");
+
+  // Normal speed is 2.1% off, double speed -0.8%.
+  using b57600 = xtd::uart_baud<16000000, 57600>;
+  static_assert(b57600::x2 && b57600::ubrr == 34 && b57600::actual_baud == 57142, "");
+  static_assert(b57600::error_ppm == -7936, "");
+
+  // Double speed is closer at +1.5%, but only normal speed's -1.7% is within its limit.
+  using b57600_within = xtd::uart_baud<14500000, 57600>;
+  static_assert(!b57600_within::x2 && b57600_within::error_ppm == -16655, "");
+
+  // Normal speed is 3.5% off, double speed +2.1%. Both exceed the default limits, the double
+  // speed limit has to be raised explicitly.
+  using b115200 = xtd::uart_baud<16000000, 115200, UART_BAUD_MAX_ERROR_PPM,
+                                 xtd::uart_speed::automatic, 25000>;
+  static_assert(b115200::x2 && b115200::ubrr == 16 && b115200::actual_baud == 117647, "");
+  static_assert(b115200::error_ppm == 21241, "");
+
+  // Exact with a baud rate crystal.
+  using b115200_xtal = xtd::uart_baud<18432000, 115200>;
+  static_assert(!b115200_xtal::x2 && b115200_xtal::ubrr == 9 && b115200_xtal::error_ppm == 0, "");
+
+  // Only reachable in double speed mode.
+  using b2M = xtd::uart_baud<16000000, 2000000>;
+  static_assert(b2M::x2 && b2M::ubrr == 0 && b2M::error_ppm == 0, "");
+
+  // The mode can be forced.
+  using forced = xtd::uart_baud<16000000, 115200, 40000, xtd::uart_speed::normal>;
+  static_assert(!forced::x2 && forced::ubrr == 8 && forced::error_ppm == -35493, "");
+}
+
+TEST(Usart, Transmit) {
+  link_type link;
+  link.configure();
+
+  const uint8_t data[] = {'a', 'b', 'c', 'd'};
+  ASSERT_TRUE(link.try_put('x'));
+  ASSERT_TRUE(UCSR0B & _BV(UDRIE0));
+  ASSERT_EQ(3, link.try_write(data, 4));  // Only room for 3
+  ASSERT_FALSE(link.try_put('y'));
+
+  for (char expected : {'x', 'a', 'b', 'c'}) {
+    link.on_udre();
+    ASSERT_EQ(expected, UDR0);
+  }
+  ASSERT_TRUE(UCSR0B & _BV(UDRIE0));
+  link.on_udre();
+  ASSERT_FALSE(UCSR0B & _BV(UDRIE0));
+}
+
+TEST(Usart, Receive) {
+  link_type link;
+  link.configure();
+
+  UCSR0A = 0;
+  UDR0 = 'h';
+  link.on_rx();
+  UCSR0A = _BV(FE0);
+  UDR0 = 'i';
+  link.on_rx();
+  UCSR0A = 0;
+  UDR0 = '!';
+  link.on_rx();  // Buffer full
+
+  ASSERT_EQ(2, link.rx_available());
+  ASSERT_EQ('h', link.peek());
+  ASSERT_EQ('h', link.get());
+  ASSERT_EQ('i', link.get());
+  ASSERT_EQ(-1, link.get());
+  ASSERT_EQ(xtd::uart_rx_flags::frame_error | xtd::uart_rx_flags::overflow, link.rx_errors());
+  ASSERT_EQ(0, link.rx_errors());
+}
@@ -0,0 +1,200 @@
+// Host side decoder for the binary log of "xtd_uc/log.hpp".
+//
+// Usage:
+//     xtd_log_decode <table> [seconds per tick] < capture
+//
+// Where <table> is the ".xtd_log" section extracted from the firmware ELF file with:
+//     avr-objcopy -O binary --only-section=.xtd_log firmware.elf firmware.log
+//
+// The capture is the raw byte stream from the UART, e.g. /dev/ttyUSB0 configured with stty. The
+// seconds per tick defaults to that of steady_clock on a 16 MHz MCU, 1024 / 16000000.
+//
+// The messages are formatted with the same code as xtd::format() on the MCU, built for the host.
+
+#include "xtd_uc/format.hpp"
+#include "xtd_uc/log.hpp"
+#include "xtd_uc/slip.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+struct stdout_tag {};
+
+namespace xtd {
+  template <>
+  class ostream<stdout_tag> {
+  public:
+    void put(char c) { std::putchar(c); }
+  };
+}  // namespace xtd
+
+namespace {
+  struct entry {
+    std::string file;
+    uint16_t line;
+    std::string format;
+  };
+
+  // The table is a sequence of "\x01" file "\0" line "\0" format "\0" records, possibly with
+  // alignment padding in between.
+  bool load_table(const char* path, std::map<uint16_t, entry>& table) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+      return false;
+    }
+    const std::vector<char> data((std::istreambuf_iterator<char>(in)),
+                                 std::istreambuf_iterator<char>());
+    size_t i = 0;
+    auto next_string = [&]() {
+      std::string s;
+      while (i < data.size() && data[i]) {
+        s.push_back(data[i++]);
+      }
+      i++;
+      return s;
+    };
+    while (i < data.size()) {
+      if (data[i++] != '\x01') {
+        continue;
+      }
+      entry e;
+      e.file = next_string();
+      e.line = uint16_t(std::atoi(next_string().c_str()));
+      e.format = next_string();
+      const uint16_t id = xtd::detail::log_id(e.file.c_str(), e.line);
+      const auto it = table.find(id);
+      if (it != table.end() && (it->second.file != e.file || it->second.line != e.line)) {
+        std::cerr << "warning: " << e.file << ":" << e.line << " and " << it->second.file << ":"
+                  << it->second.line << " have the same ID " << id << "\n";
+      }
+      table[id] = e;
+    }
+    return true;
+  }
+
+  uint64_t get_le(const uint8_t* p, uint8_t n) {
+    uint64_t v = 0;
+    for (uint8_t i = 0; i < n; ++i) {
+      v |= uint64_t(p[i]) << (8 * i);
+    }
+    return v;
+  }
+
+  int64_t sign_extend(uint64_t v, uint8_t n) {
+    const uint8_t shift = uint8_t(64 - 8 * n);
+    return int64_t(v << shift) >> shift;
+  }
+
+  void print_frame(const std::map<uint16_t, entry>& table, double tick, const uint8_t* data,
+                   uint8_t size) {
+    using xtd::detail::format_arg;
+    using xtd::detail::format_kind;
+
+    if (size < 2) {
+      std::cout << "<short frame>" << std::endl;
+      return;
+    }
+    const auto id = uint16_t(get_le(data, 2));
+    if (id == 0 && size == 4) {
+      std::cout << "<" << get_le(data + 2, 2) << " records dropped>" << std::endl;
+      return;
+    }
+    if (size < 6) {
+      std::cout << "<short frame>" << std::endl;
+      return;
+    }
+    const auto it = table.find(id);
+    if (it == table.end()) {
+      std::cout << "<unknown ID " << id << ">" << std::endl;
+      return;
+    }
+
+    std::vector<format_arg> args;
+    for (uint8_t i = 6; i < size;) {
+      const auto kind = format_kind(data[i] & 0x0F);
+      const auto n = uint8_t(data[i] >> 4);
+      i++;
+      if (i + n > size || n > 8) {
+        std::cout << "<corrupt frame>" << std::endl;
+        return;
+      }
+      const auto v = get_le(data + i, n);
+      i = uint8_t(i + n);
+      switch (kind) {
+        case format_kind::boolean:
+          args.emplace_back(v != 0);
+          break;
+        case format_kind::character:
+          args.emplace_back(char(v));
+          break;
+        case format_kind::signed32:
+        case format_kind::signed64:
+          args.emplace_back(sign_extend(v, n));
+          break;
+        case format_kind::unsigned32:
+        case format_kind::unsigned64:
+          args.emplace_back(v);
+          break;
+        case format_kind::floating: {
+          const auto bits = uint32_t(v);
+          float f;
+          std::memcpy(&f, &bits, sizeof(f));
+          args.emplace_back(f);
+          break;
+        }
+        default:
+          std::cout << "<corrupt frame>" << std::endl;
+          return;
+      }
+    }
+
+    const auto& e = it->second;
+    std::printf("%12.6f %s:%u: ", get_le(data + 2, 4) * tick, e.file.c_str(), e.line);
+    xtd::ostream<stdout_tag> os;
+    xtd::detail::vformat(os, e.format.c_str(), args.data());
+    std::printf("\n");
+    std::fflush(stdout);
+  }
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2 || argc > 3) {
+    std::cerr << "usage: " << argv[0] << " <table> [seconds per tick] < capture\n";
+    return 1;
+  }
+  std::map<uint16_t, entry> table;
+  if (!load_table(argv[1], table)) {
+    std::cerr << "Couldn't read " << argv[1] << "\n";
+    return 1;
+  }
+  const double tick = argc == 3 ? std::atof(argv[2]) : 1024.0 / 16000000.0;
+
+  xtd::slip_decoder<253> decoder;
+  int c;
+  while ((c = std::getchar()) != EOF) {
+    switch (decoder.push(uint8_t(c))) {
+      case xtd::slip_status::frame:
+        print_frame(table, tick, decoder.data(), decoder.size());
+        decoder.release();
+        break;
+      case xtd::slip_status::crc_error:
+        std::cout << "<CRC error>" << std::endl;
+        break;
+      case xtd::slip_status::overrun:
+      case xtd::slip_status::escape_error:
+        std::cout << "<framing error>" << std::endl;
+        break;
+      case xtd::slip_status::pending:
+        break;
+    }
+  }
+  return 0;
+}